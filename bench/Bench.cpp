@@ -0,0 +1,342 @@
+/* Renderer benchmark */
+/* Renders a fixed number of frames of synthetic scenes (headless by default) and writes the frame */
+/* timing statistics, draw counts and startup times to a JSON file. */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "App/App.h"
+#include "App/FrameStats.h"
+#include "App/GpuTimer.h"
+
+namespace {
+
+/// A synthetic workload: `objects` draw calls per frame of a mesh made of `triangles` triangles
+struct Scene
+{
+    unsigned long objects = 1;
+    unsigned long triangles = 2;
+};
+
+struct SceneResult
+{
+    Scene scene;
+    unsigned long long drawCalls = 0;
+    double seconds = 0.0;
+    std::vector<App::FrameStats::Summary> cpu;
+    std::vector<App::FrameStats::Summary> gpu;
+};
+
+struct Options
+{
+    unsigned long frames = 1000;
+    unsigned long warmupFrames = 100;
+    std::string output = "bench.json";
+    std::vector<Scene> scenes;
+};
+
+void PrintUsage(char const *program)
+{
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --frames N         measured frames per scene (default 1000)\n"
+              << "  --warmup N         frames rendered before measuring (default 100)\n"
+              << "  --width W          framebuffer width (default 640)\n"
+              << "  --height H         framebuffer height (default 480)\n"
+              << "  --scene OBJ:TRI    add a scene of OBJ draw calls of a TRI triangle mesh\n"
+              << "  --out FILE         JSON output (default bench.json)\n"
+              << "  --window           render into a visible window instead of offscreen\n";
+}
+
+unsigned long ParseNumber(char const *text)
+{
+    return std::strtoul(text, nullptr, 10);
+}
+
+Options ParseCommandLine(int argc, char *argv[]) // NOLINT
+{
+    Options options;
+    App::headless = true;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view const arg = argv[i];                     // NOLINT
+        char const *value = i + 1 < argc ? argv[i + 1] : nullptr; // NOLINT
+
+        if (arg == "--window")
+        {
+            App::headless = false;
+            continue;
+        }
+
+        if (value == nullptr)
+        {
+            PrintUsage(argv[0]); // NOLINT
+            exit(1);             // NOLINT
+        }
+        ++i;
+
+        if (arg == "--frames")
+        {
+            options.frames = ParseNumber(value);
+        }
+        else if (arg == "--warmup")
+        {
+            options.warmupFrames = ParseNumber(value);
+        }
+        else if (arg == "--width")
+        {
+            App::screenWidth = static_cast<int>(ParseNumber(value));
+        }
+        else if (arg == "--height")
+        {
+            App::screenHeight = static_cast<int>(ParseNumber(value));
+        }
+        else if (arg == "--scene")
+        {
+            char *end = nullptr;
+            Scene scene;
+            scene.objects = std::strtoul(value, &end, 10);
+            scene.triangles = *end == ':' ? std::strtoul(end + 1, nullptr, 10) : 2; // NOLINT
+            options.scenes.push_back(scene);
+        }
+        else if (arg == "--out")
+        {
+            options.output = value;
+        }
+        else
+        {
+            PrintUsage(argv[0]); // NOLINT
+            exit(1);             // NOLINT
+        }
+    }
+
+    if (options.scenes.empty())
+    {
+        // Default suite: per-frame overhead, draw call overhead, vertex throughput and fill rate
+        options.scenes = {{1, 2}, {200, 2}, {1, 200000}, {50, 2000}};
+    }
+
+    return options;
+}
+
+/// Generate a grid of (at least) `triangles` triangles covering the same area as the default quad,
+/// with the vertex colors forming a gradient.
+///
+/// @return void
+void GenerateGrid(unsigned long triangles, std::vector<GLfloat> &vertexData,
+                  std::vector<GLuint> &indexData)
+{
+    // Each cell of the grid is made of two triangles
+    unsigned long const cells = std::max(1UL, (triangles + 1) / 2);
+    auto const columns = static_cast<unsigned long>(std::ceil(std::sqrt(cells)));
+    unsigned long const rows = (cells + columns - 1) / columns;
+
+    vertexData.clear();
+    vertexData.reserve((rows + 1) * (columns + 1) * 6);
+    for (unsigned long row = 0; row <= rows; ++row)
+    {
+        for (unsigned long column = 0; column <= columns; ++column)
+        {
+            auto const u = static_cast<GLfloat>(column) / static_cast<GLfloat>(columns);
+            auto const v = static_cast<GLfloat>(row) / static_cast<GLfloat>(rows);
+            vertexData.insert(vertexData.end(), {u - 0.5F, v - 0.5F, 0.0F, u, v, 1.0F - u});
+        }
+    }
+
+    indexData.clear();
+    indexData.reserve(triangles * 3);
+    for (unsigned long cell = 0; cell < cells && indexData.size() < triangles * 3; ++cell)
+    {
+        auto const row = static_cast<GLuint>(cell / columns);
+        auto const column = static_cast<GLuint>(cell % columns);
+        auto const stride = static_cast<GLuint>(columns + 1);
+        GLuint const bottomLeft = (row * stride) + column;
+        GLuint const topLeft = bottomLeft + stride;
+
+        indexData.insert(indexData.end(), {topLeft, bottomLeft, bottomLeft + 1});
+        if (indexData.size() < triangles * 3)
+        {
+            indexData.insert(indexData.end(), {topLeft + 1, topLeft, bottomLeft + 1});
+        }
+    }
+}
+
+/// Run the main loop for the given number of frames
+///
+/// @return void
+void RunFrames(unsigned long frames)
+{
+    App::frameCount = 0;
+    App::frameLimit = frames;
+    App::MainLoop();
+}
+
+SceneResult RunScene(Scene const &scene, Options const &options)
+{
+    std::vector<GLfloat> vertexData;
+    std::vector<GLuint> indexData;
+    GenerateGrid(scene.triangles, vertexData, indexData);
+    App::VertexSpecification(vertexData, indexData);
+    App::objectCount = scene.objects;
+
+    RunFrames(options.warmupFrames);
+
+    App::FrameStats::Reset();
+    App::GpuTimer::Reset();
+    unsigned long long const drawCallsBefore = App::drawCallCount;
+
+    auto const start = std::chrono::steady_clock::now();
+    RunFrames(options.frames);
+    glFinish();
+    auto const end = std::chrono::steady_clock::now();
+
+    SceneResult result;
+    result.scene = scene;
+    result.drawCalls = App::drawCallCount - drawCallsBefore;
+    result.seconds = std::chrono::duration<double>(end - start).count();
+
+    for (std::size_t i = 0; i < static_cast<std::size_t>(App::FrameStats::Phase::Count); ++i)
+    {
+        result.cpu.push_back(App::FrameStats::Query(static_cast<App::FrameStats::Phase>(i)));
+    }
+    for (std::size_t i = 0; i < static_cast<std::size_t>(App::GpuTimer::Pass::Count); ++i)
+    {
+        result.gpu.push_back(App::GpuTimer::Query(static_cast<App::GpuTimer::Pass>(i)));
+    }
+
+    return result;
+}
+
+/// Quote and escape a string for JSON
+std::string Quoted(char const *text)
+{
+    std::string quoted = "\"";
+    for (char const *c = text; c != nullptr && *c != '\0'; ++c) // NOLINT
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            quoted += '\\';
+        }
+        if (static_cast<unsigned char>(*c) >= 0x20)
+        {
+            quoted += *c;
+        }
+    }
+
+    return quoted + '"';
+}
+
+std::string Quoted(GLubyte const *text)
+{
+    return Quoted(reinterpret_cast<char const *>(text)); // NOLINT
+}
+
+void WriteSummary(std::ostream &out, char const *name, App::FrameStats::Summary const &summary,
+                  bool last)
+{
+    out << "        " << Quoted(name) << ": {\"p50_ms\": " << summary.p50
+        << ", \"p95_ms\": " << summary.p95 << ", \"p99_ms\": " << summary.p99
+        << ", \"max_ms\": " << summary.max << ", \"samples\": " << summary.samples << "}"
+        << (last ? "\n" : ",\n");
+}
+
+void WriteJson(std::ostream &out, Options const &options, std::vector<double> const &startup,
+               std::vector<SceneResult> const &results)
+{
+    out << "{\n";
+    out << "  \"renderer\": " << Quoted(glGetString(GL_RENDERER)) << ",\n";
+    out << "  \"version\": " << Quoted(glGetString(GL_VERSION)) << ",\n";
+    out << "  \"headless\": " << (App::headless ? "true" : "false") << ",\n";
+    out << "  \"width\": " << App::screenWidth << ",\n";
+    out << "  \"height\": " << App::screenHeight << ",\n";
+    out << "  \"frames\": " << options.frames << ",\n";
+    out << "  \"warmup_frames\": " << options.warmupFrames << ",\n";
+    out << "  \"startup_ms\": {\"initialize\": " << startup[0]
+        << ", \"vertex_specification\": " << startup[1]
+        << ", \"create_graphics_pipeline\": " << startup[2] << "},\n";
+    out << "  \"scenes\": [\n";
+
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        SceneResult const &r = results[i];
+        double const fps = r.seconds > 0.0 ? static_cast<double>(options.frames) / r.seconds : 0.0;
+
+        out << "    {\n";
+        out << "      \"objects\": " << r.scene.objects << ",\n";
+        out << "      \"triangles\": " << r.scene.triangles << ",\n";
+        out << "      \"draw_calls\": " << r.drawCalls << ",\n";
+        out << "      \"seconds\": " << r.seconds << ",\n";
+        out << "      \"fps\": " << fps << ",\n";
+        out << "      \"cpu\": {\n";
+        for (std::size_t p = 0; p < r.cpu.size(); ++p)
+        {
+            WriteSummary(out, App::FrameStats::PhaseName(static_cast<App::FrameStats::Phase>(p)),
+                         r.cpu[p], p + 1 == r.cpu.size());
+        }
+        out << "      },\n";
+        out << "      \"gpu\": {\n";
+        for (std::size_t p = 0; p < r.gpu.size(); ++p)
+        {
+            WriteSummary(out, App::GpuTimer::PassName(static_cast<App::GpuTimer::Pass>(p)),
+                         r.gpu[p], p + 1 == r.gpu.size());
+        }
+        out << "      }\n";
+        out << "    }" << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+}
+
+/// Time a startup step in milliseconds
+template <typename Step>
+double TimeStep(Step step)
+{
+    auto const start = std::chrono::steady_clock::now();
+    step();
+    glFinish();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options const options = ParseCommandLine(argc, argv);
+
+    // Same startup sequence as the application
+    std::vector<double> startup;
+    startup.push_back(TimeStep([] { App::Initialize(); }));
+    startup.push_back(TimeStep([] { App::VertexSpecification(); }));
+    startup.push_back(TimeStep([] { App::CreateGraphicsPipeline(); }));
+
+    std::vector<SceneResult> results;
+    for (Scene const &scene : options.scenes)
+    {
+        std::cout << "Scene: " << scene.objects << " objects x " << scene.triangles
+                  << " triangles" << std::endl;
+        results.push_back(RunScene(scene, options));
+    }
+
+    std::ofstream out(options.output);
+    if (!out.is_open())
+    {
+        std::cerr << "Could not open " << options.output << std::endl;
+        App::CleanUp();
+        return 1;
+    }
+    WriteJson(out, options, startup, results);
+    std::cout << "Results written to " << options.output << std::endl;
+
+    App::CleanUp();
+
+    return 0;
+}
@@ -1,15 +1,23 @@
 #pragma once
 
+#include <cstdint>
+#include <span>
+#include <vector>
+
 #include "SDL2/SDL.h"
 #include "glad/glad.h"
 
+#include "App/Mesh.h"
+#include "App/StreamBuffer.h"
+
 #define DEBUG
 #define MAX_GL_INFO_LOG_LEN 512
 
 namespace App {
 
-extern int const screenHeight; // NOLINT
-extern int const screenWidth;  // NOLINT
+// Size of the window (or the offscreen framebuffer), may be changed before `Initialize`
+extern int screenHeight; // NOLINT
+extern int screenWidth;  // NOLINT
 
 extern SDL_Window *graphicsApplicationWindow; // NOLINT
 extern SDL_GLContext openGLContext;           // NOLINT
@@ -19,8 +27,81 @@ extern GLuint vertexBufferObject; // NOLINT
 
 extern GLuint graphicsPipelineShaderProgram; // NOLINT
 
+// What `Draw` renders every frame: `objectCount` draw calls of the `indexCount` indices of the mesh
+extern GLsizei indexCount;               // NOLINT
+extern GLenum indexType;                 // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT -- NOLINT
+extern unsigned long objectCount;        // NOLINT
+extern unsigned long long drawCallCount; // Number of draw calls issued so far -- NOLINT
+
+// Headless mode renders into an offscreen framebuffer object instead of a visible window, so that
+// the main loop can be driven on machines without a display (e.g. under Mesa llvmpipe).
+extern bool headless;               // NOLINT
+extern GLuint offscreenFramebuffer; // NOLINT
+extern unsigned long frameLimit;    // Stop the main loop after this many frames (0: never) -- NOLINT
+extern unsigned long frameCount;    // Number of frames rendered so far -- NOLINT
+
+// How the main loop paces itself:
+// - Continuous: render frames back to back, as fast as possible (benchmarks)
+// - OnDemand: sleep until something marks the frame dirty (input, window events, `MarkDirty`),
+//   then render one frame. A static scene costs (almost) no CPU.
+enum class LoopMode
+{
+    Continuous,
+    OnDemand,
+};
+
+extern LoopMode loopMode; // NOLINT
+
+// Vertical synchronization of the buffer swaps (the values are SDL_GL_SetSwapInterval's). Adaptive
+// vsync swaps immediately when a frame is late instead of waiting for the next refresh; where it is
+// not supported, it falls back to `On`. Always off in headless mode.
+enum class SwapInterval
+{
+    Off = 0,
+    On = 1,
+    Adaptive = -1,
+};
+
+extern SwapInterval swapInterval; // NOLINT
+extern double targetFrameRate;    // Frame rate limit in frames per second (0: unlimited) -- NOLINT
+extern bool animate;              // Animate the scene (the background pulses) -- NOLINT
+
+/// Request a new frame in `LoopMode::OnDemand` (e.g. after an animation step or a resource change).
+/// Can be called from any thread.
+void MarkDirty();
+
+// When set, edits of the shaders on disk (./shaders unless ShaderSource::directory is set) are
+// applied while running (see ShaderWatcher)
+extern bool hotReload; // NOLINT
+
+// Shader features of the graphics pipeline (bits of ProgramPermutations::Feature)
+extern std::uint32_t shaderFeatures; // NOLINT
+
+// When set, the permutations listed in this file are built at startup, and the ones used during the
+// run are saved to it at exit
+extern char const *permutationListPath; // NOLINT
+
+// When set before `Initialize`, the OpenGL calls of the session are captured into this file
+extern char const *glCapturePath; // NOLINT
+
+// When set, the vertices are uploaded again every frame through a StreamBuffer ring, like dynamic
+// geometry would be
+extern bool streamVertices;           // NOLINT
+extern StreamBuffer::Mode streamMode; // NOLINT
+
+// When set, `VertexSpecification` loads this mesh (see Mesh::Load) instead of the built-in quad
+extern char const *meshPath;                 // NOLINT
+extern Mesh::VertexFormat meshVertexFormat; // Vertex format of that mesh -- NOLINT
+
 void Initialize();
 void VertexSpecification();
+void VertexSpecification(std::vector<GLfloat> const &vertexData,
+                         std::vector<GLuint> const &indexBufferData);
+void VertexSpecification(Mesh::Mesh const &mesh,
+                         Mesh::VertexFormat format = Mesh::VertexFormat::Float);
+void VertexSpecification(Mesh::VertexFormat format, std::span<std::byte const> vertices,
+                         Mesh::PositionTransform const &transform, GLenum indexType,
+                         std::span<std::byte const> indices);
 void CreateGraphicsPipeline();
 void MainLoop();
 void CleanUp();
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+
+// The shaders, embedded into the binary at build time (see the Makefile): in the application, the
+// minified source of every permutation written by `make shaders` (build/shaders/*.glsl); in the
+// shader tool, the shaders/*.glsl files themselves.
+//
+// Cold start reads the shaders from here without any filesystem access, whatever the working
+// directory. ShaderSource only reads them from disk when told to (e.g. for hot reload).
+namespace App::EmbeddedShaders {
+
+struct File
+{
+    std::string_view name;   // Relative to the shaders directory, e.g. "vert.USE_FOG.glsl"
+    std::string_view source; // Contents of the file
+};
+
+/// An embedded file by name
+///
+/// @return File const * the file, nullptr if there is no such file
+File const *Find(std::string_view name);
+
+/// All the embedded files
+std::span<File const> All();
+
+} // namespace App::EmbeddedShaders
@@ -0,0 +1,20 @@
+#pragma once
+
+// Frame rate limiter
+//
+// Waits until the start of the next frame slot: sleeps for the bulk of the remaining time (the OS
+// sleep is coarse and may oversleep), then spins for the last `spinThreshold` to hit the deadline
+// precisely. Deadlines advance by exactly one period per frame so the average rate does not drift;
+// a frame that is more than one period late restarts the schedule instead of rushing to catch up.
+namespace App::FramePacer {
+
+/// Seconds before the deadline at which sleeping stops and spinning begins
+constexpr double spinThreshold = 0.002;
+
+/// Frames per second to pace to (0: unlimited, `WaitForNextFrame` returns immediately)
+void SetTargetFrameRate(double framesPerSecond);
+
+/// Block until the next frame may start
+void WaitForNextFrame();
+
+} // namespace App::FramePacer
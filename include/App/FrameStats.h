@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace App::FrameStats {
+
+using Clock = std::chrono::steady_clock;
+
+// Number of most recent samples the statistics are computed over (power of two)
+constexpr std::size_t windowSize = 1024;
+
+/// The phases of one iteration of the main loop that are timed
+enum class Phase : std::uint8_t
+{
+    Input,
+    Update, // Fixed timestep simulation steps
+    PreDraw,
+    Draw,
+    Swap,
+    Frame,    // The whole iteration
+    Interval, // From the start of one frame to the start of the next (frame pacing)
+    Count,
+};
+
+/// Percentiles of a rolling window (in milliseconds)
+struct Summary
+{
+    double p50{};
+    double p95{};
+    double p99{};
+    double max{};
+    std::size_t samples{};
+};
+
+/// Fixed size ring of the last `windowSize` samples (in nanoseconds).
+///
+/// Recording is wait-free and meant for a single writer (the render thread). Readers may run on any
+/// thread at any time: they never block the writer, at worst a sample that is being overwritten
+/// during the copy is read as the newer value.
+struct RollingWindow
+{
+    void Record(std::uint64_t nanoseconds);
+    Summary Summarize() const;
+    void Reset();
+
+private:
+    std::array<std::atomic<std::uint64_t>, windowSize> samples{};
+    std::atomic<std::uint64_t> count{0};
+};
+
+/// Add one timing sample of the given phase
+void Record(Phase phase, std::uint64_t nanoseconds);
+
+/// Compute the statistics of the given phase over the rolling window. Safe to call at runtime, from
+/// any thread.
+Summary Query(Phase phase);
+
+/// Forget all the samples recorded so far
+void Reset();
+
+/// Print the statistics of all phases as a table
+void Dump(std::ostream &out);
+
+/// Print one row of the table printed by `Dump` (used to report other timings alongside)
+void DumpRow(std::ostream &out, char const *name, Summary const &summary);
+
+char const *PhaseName(Phase phase);
+
+/// Records the time between its construction and destruction as a sample of the given phase
+struct ScopedTimer
+{
+    explicit ScopedTimer(Phase phase) : phase{phase}, start{Clock::now()}
+    {
+    }
+
+    ~ScopedTimer()
+    {
+        auto const elapsed = Clock::now() - start;
+        Record(phase, static_cast<std::uint64_t>(
+                          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    ScopedTimer(ScopedTimer const &) = delete;
+    ScopedTimer &operator=(ScopedTimer const &) = delete;
+    ScopedTimer(ScopedTimer &&) = delete;
+    ScopedTimer &operator=(ScopedTimer &&) = delete;
+
+private:
+    Phase phase;
+    Clock::time_point start;
+};
+
+} // namespace App::FrameStats
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+
+// Binary format of a captured OpenGL command stream (written by GLRecorder, read by the replay
+// tool).
+//
+// The file starts with a `CaptureHeader`, followed by commands. Each command is a
+// `CommandHeader` (opcode and payload size) followed by its payload: the arguments of the call in
+// order, as little-endian integers/floats of the GL type's size. Object names are the ones the
+// driver returned during the capture; the replayer maps them to its own. Pointers into buffer
+// objects (vertex attribute and index offsets) are stored as 64-bit offsets. Buffer contents and
+// shader sources are stored inline.
+namespace App::GLCapture {
+
+constexpr std::uint32_t magic = 0x43524C47; // "GLRC"
+constexpr std::uint32_t version = 1;
+
+struct CaptureHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::int32_t width; // Size of the default framebuffer during the capture
+    std::int32_t height;
+};
+
+struct CommandHeader
+{
+    std::uint16_t op;
+    std::uint32_t size; // Payload size in bytes
+};
+
+constexpr std::uint32_t commandHeaderSize = sizeof(std::uint16_t) + sizeof(std::uint32_t);
+
+/// Opcodes. Never renumber: append new calls at the end (and bump `version` when changing the
+/// payload of an existing one).
+enum class Op : std::uint16_t
+{
+    Frame = 0, // Start of a frame of the main loop (no payload)
+
+    GenVertexArrays,          // n, names[n]
+    DeleteVertexArrays,       // n, names[n]
+    BindVertexArray,          // array
+    GenBuffers,               // n, names[n]
+    DeleteBuffers,            // n, names[n]
+    BindBuffer,               // target, buffer
+    BufferData,               // target, size (u64), usage, hasData (u8), data[size]
+    BufferSubData,            // target, offset (u64), size (u64), data[size]
+    EnableVertexAttribArray,  // index
+    DisableVertexAttribArray, // index
+    VertexAttribPointer,      // index, size, type, normalized (u8), stride, offset (u64)
+
+    CreateShader,    // type, name
+    ShaderSource,    // shader, length (u32), source[length]
+    CompileShader,   // shader
+    DeleteShader,    // shader
+    CreateProgram,   // name
+    AttachShader,    // program, shader
+    DetachShader,    // program, shader
+    LinkProgram,     // program
+    ValidateProgram, // program
+    UseProgram,      // program
+    DeleteProgram,   // program
+
+    Enable,       // cap
+    Disable,      // cap
+    Viewport,     // x, y, width, height
+    ClearColor,   // r, g, b, a
+    Clear,        // mask
+    DrawArrays,   // mode, first, count
+    DrawElements, // mode, count, type, offset (u64)
+
+    GenFramebuffers,         // n, names[n]
+    DeleteFramebuffers,      // n, names[n]
+    BindFramebuffer,         // target, framebuffer
+    GenRenderbuffers,        // n, names[n]
+    DeleteRenderbuffers,     // n, names[n]
+    BindRenderbuffer,        // target, renderbuffer
+    RenderbufferStorage,     // target, internalformat, width, height
+    FramebufferRenderbuffer, // target, attachment, renderbuffertarget, renderbuffer
+
+    DrawElementsInstanced, // mode, count, type, offset (u64), instancecount
+
+    // Uniform locations are replayed as captured (same shaders, same driver)
+    ProgramUniform1i,        // program, location, v0
+    ProgramUniform1f,        // program, location, v0
+    ProgramUniform2fv,       // program, location, count, value[2 * count]
+    ProgramUniform3fv,       // program, location, count, value[3 * count]
+    ProgramUniform4fv,       // program, location, count, value[4 * count]
+    ProgramUniformMatrix4fv, // program, location, count, transpose (u8), value[16 * count]
+
+    ProgramParameteri,      // program, pname, value
+    GenProgramPipelines,    // n, names[n]
+    DeleteProgramPipelines, // n, names[n]
+    BindProgramPipeline,    // pipeline
+    UseProgramStages,       // pipeline, stages, program
+
+    DepthFunc, // func
+    DepthMask, // flag (u8)
+    CullFace,  // mode
+    FrontFace, // mode
+    BlendFunc, // sfactor, dfactor
+
+    Count,
+};
+
+} // namespace App::GLCapture
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+
+#include "glad/glad.h"
+
+// OpenGL error checking policy, selected at compile time with APP_GL_CHECK (`make GL_CHECK=n`):
+//
+// 0 (off)       GLCall(X) is just X. Nothing is checked: no cost at all (release builds).
+// 1 (per-frame) GLCall(X) only remembers its call site in a small ring. `CheckFrame` (called once
+//               per frame after presenting) calls glGetError once; on error it reports the recent
+//               call sites and checks every GLCall of the next frame individually to pinpoint the
+//               first offending call.
+// 2 (per-call)  Every GLCall(X) clears the error state before and checks it after X. Exact, but
+//               each check is a glGetError round trip that synchronizes with the driver.
+#ifndef APP_GL_CHECK
+#define APP_GL_CHECK 1
+#endif
+
+#if APP_GL_CHECK == 0
+
+#define GLCall(X) X
+
+#elif APP_GL_CHECK == 1
+
+#define GLCall(X)                                                                                  \
+    do                                                                                             \
+    {                                                                                              \
+        App::GLCheck::RecordCallSite(#X, __FILE__, __LINE__);                                      \
+        if (App::GLCheck::checkEveryCall)                                                          \
+        {                                                                                          \
+            App::GLCheck::ClearAllErrors();                                                        \
+            X;                                                                                     \
+            App::GLCheck::CheckErrorStatus(#X, __FILE__, __LINE__);                                \
+        }                                                                                          \
+        else                                                                                       \
+        {                                                                                          \
+            X;                                                                                     \
+        }                                                                                          \
+    } while (false)
+
+#else
+
+/// Wraps call to OpenGL functions. First clears any previously set error state,
+/// then it executes the function call, and finally checks for the errors,
+/// passing the string of the function call (#X) and the location (__FILE__, __LINE__)
+/// at which the error has happened.
+///
+/// @param X function call including function name all its parameters
+#define GLCall(X)                                                                                  \
+    do                                                                                             \
+    {                                                                                              \
+        App::GLCheck::ClearAllErrors();                                                            \
+        X;                                                                                         \
+        App::GLCheck::CheckErrorStatus(#X, __FILE__, __LINE__);                                    \
+    } while (false)
+
+#endif
+
+namespace App::GLCheck {
+
+// Number of recent call sites remembered in per-frame mode (power of two)
+constexpr std::size_t callSiteRingSize = 64;
+
+// Set for the frame after an error was detected in per-frame mode
+extern bool checkEveryCall; // NOLINT
+
+/// Remember a GLCall site (per-frame mode): three stores into a ring, no OpenGL call
+void RecordCallSite(char const *call, char const *file, int line);
+
+/// Clear the error state until no error exists.
+/// This is because in OpenGL and a call to glGetError no other error is recorded until.
+/// 1. glGetError is called,
+/// 2. the error code is returned,
+/// 3. the flag is set to GL_NO_ERROR.
+///
+/// @return void
+void ClearAllErrors();
+
+/// Check if an error has occured and return the error code and show where it happend.
+/// This function is usually called after a call to some OpenGL function (starting with gl).
+///
+/// @param call the OpenGL call after which the error has been detected
+/// @param file source file of the call
+/// @param line line number at which the error has happend
+/// @return bool whether any error has occurred or not
+bool CheckErrorStatus(char const *call, char const *file, int line);
+
+/// Once per frame error check (per-frame mode; no-op otherwise)
+///
+/// @return bool whether any error has occurred during the frame
+bool CheckFrame();
+
+/// Name of an OpenGL error code (e.g. "GL_INVALID_ENUM")
+char const *ErrorName(GLenum error);
+
+} // namespace App::GLCheck
@@ -0,0 +1,21 @@
+#pragma once
+
+namespace App::GLRecorder {
+
+/// Start capturing the OpenGL calls of the session into `path` (see GLCapture.h for the format).
+/// Must be called after the OpenGL functions have been loaded (gladLoadGLLoader): the recorder
+/// swaps the loaded function pointers for recording wrappers, so calls made through glad are
+/// captured without any change to the calling code, and cost nothing while not recording.
+///
+/// @return bool whether the capture file could be opened
+bool Start(char const *path, int width, int height);
+
+/// Mark the start of a frame of the main loop
+void Frame();
+
+/// Restore the original function pointers, flush and close the capture file
+void Stop();
+
+bool IsRecording();
+
+} // namespace App::GLRecorder
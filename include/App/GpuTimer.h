@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#include "App/FrameStats.h"
+
+namespace App::GpuTimer {
+
+// Number of frames a query may stay in flight before its slot is needed again. Results are read
+// back this many frames late, so the CPU never waits for the GPU to catch up.
+constexpr std::size_t ringSize = 4;
+
+/// The GPU passes that are timed
+enum class Pass : std::uint8_t
+{
+    PreDraw, // The clear
+    Draw,    // The draw calls
+    Count,
+};
+
+/// Create the query objects (requires a current OpenGL context)
+void Initialize();
+
+/// Delete the query objects
+void CleanUp();
+
+/// Start/stop measuring the GPU time of a pass (GL_TIME_ELAPSED). Only one pass can be measured at a
+/// time: calls must not be nested.
+void Begin(Pass pass);
+void End(Pass pass);
+
+/// Collect the results that became available without blocking and advance to the next slot of the
+/// ring. Called once per frame after presenting.
+void EndFrame();
+
+/// Statistics of the given pass over the rolling window (in milliseconds)
+FrameStats::Summary Query(Pass pass);
+
+void Reset();
+
+/// Print the statistics of all passes as rows of the `FrameStats::Dump` table
+void Dump(std::ostream &out);
+
+char const *PassName(Pass pass);
+
+} // namespace App::GpuTimer
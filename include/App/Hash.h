@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace App {
+
+constexpr std::uint64_t fnv1aOffsetBasis = 0xcbf29ce484222325ULL;
+constexpr std::uint64_t fnv1aPrime = 0x100000001b3ULL;
+
+/// 64-bit FNV-1a hash of a string. Usable at compile time; pass the previous hash as `hash` to hash
+/// several strings as one.
+///
+/// @param text the bytes to hash
+/// @param hash the hash to continue from
+/// @return std::uint64_t the hash
+constexpr std::uint64_t Fnv1a64(std::string_view text, std::uint64_t hash = fnv1aOffsetBasis)
+{
+    for (char const c : text)
+    {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= fnv1aPrime;
+    }
+
+    return hash;
+}
+
+} // namespace App
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+#include "glad/glad.h"
+
+// Meshes and mesh loading
+//
+// A mesh is what `VertexSpecification` uploads (once packed, see below): interleaved vertices and
+// the indices of its triangles. `Load` reads Wavefront OBJ and
+// binary glTF (.glb) files. The file is read in one go and parsed on worker threads (OBJ: one chunk
+// of lines per thread; glTF: one primitive per thread), and identical vertices are merged.
+//
+// `Pack` encodes the vertices in a vertex format for the vertex buffer. The compact formats
+// quantize the attributes, which the vertex fetch converts back with normalized attribute types:
+// positions relative to the bounds of the mesh (undone in the vertex shader by
+// `PositionTransform`) and unorm8 colors. Only the attributes the shaders read are uploaded: the
+// normals are loaded but stay out of the vertex buffer until a shader uses them. `PackIndices`
+// stores the indices as 16-bit integers whenever the vertices allow it.
+namespace App::Mesh {
+
+/// One vertex as loaded (the position and color are attribute locations 0 and 1)
+struct Vertex
+{
+    std::array<GLfloat, 3> position;
+    std::array<GLfloat, 3> color;  // White when the file has no vertex colors
+    std::array<GLfloat, 3> normal; // Zero when the file has no normals (not uploaded)
+};
+
+struct Mesh
+{
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices; // Three per triangle
+    std::array<GLfloat, 3> boundsMin{};
+    std::array<GLfloat, 3> boundsMax{};
+};
+
+/// How the vertices are stored in the vertex buffer
+enum class VertexFormat : std::uint8_t
+{
+    Float,   // 24 bytes: float position and color
+    Half,    // 12 bytes: half float position, unorm8 color
+    Snorm16, // 12 bytes: snorm16 position, unorm8 color
+};
+
+/// Dequantization of the stored positions: position = stored position * scale + offset
+struct PositionTransform
+{
+    std::array<GLfloat, 3> scale{1.0F, 1.0F, 1.0F};
+    std::array<GLfloat, 3> offset{};
+};
+
+/// Vertices encoded in a vertex format, ready to be copied into a vertex buffer
+struct PackedVertices
+{
+    VertexFormat format = VertexFormat::Float;
+    std::vector<std::byte> data;
+    PositionTransform transform;
+};
+
+/// How one attribute is stored (the arguments of glVertexAttribPointer)
+struct AttributeFormat
+{
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    std::size_t offset;
+};
+
+/// Indices in an index type, ready to be copied into an index buffer
+struct PackedIndices
+{
+    GLenum type = GL_UNSIGNED_INT; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    std::vector<std::byte> data;
+};
+
+/// Size of one vertex (the stride of the attributes)
+std::size_t VertexSize(VertexFormat format);
+
+/// Formats of the position and color attributes (locations 0 and 1)
+std::array<AttributeFormat, 2> Attributes(VertexFormat format);
+
+/// Parse a vertex format name ("float", "half" or "snorm16")
+///
+/// @return bool whether the name is valid (an error is printed otherwise)
+bool ParseVertexFormat(std::string_view name, VertexFormat &format);
+
+char const *ToString(VertexFormat format);
+
+/// Encode the vertices of a mesh (the bounds of the mesh must be up to date)
+///
+/// @return PackedVertices the encoded vertices
+PackedVertices Pack(Mesh const &mesh, VertexFormat format);
+
+/// Size of one index of an index type
+std::size_t IndexSize(GLenum type);
+
+/// Store the indices of a mesh in the smallest index type that can address all of its vertices
+///
+/// @return PackedIndices GL_UNSIGNED_SHORT indices for up to 65536 vertices, GL_UNSIGNED_INT ones
+/// otherwise
+PackedIndices PackIndices(Mesh const &mesh);
+
+/// Load a mesh from an OBJ or a glTF binary file (chosen by extension)
+///
+/// @param path the file
+/// @param mesh the loaded mesh
+/// @param threads number of worker threads (0: one per hardware thread)
+/// @return bool whether the mesh could be loaded (the reason is printed otherwise)
+bool Load(std::filesystem::path const &path, Mesh &mesh, unsigned threads = 0);
+
+/// Merge identical vertices (same bits) and remap the indices
+///
+/// @return void
+void Deduplicate(Mesh &mesh);
+
+/// Compute the bounding box of the vertices
+///
+/// @return void
+void ComputeBounds(Mesh &mesh);
+
+} // namespace App::Mesh
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <iosfwd>
+#include <span>
+#include <string>
+
+#include "glad/glad.h"
+
+#include "App/Mesh.h"
+
+// On-disk cache of meshes baked into their GPU layout
+//
+// The first import of a mesh file stores the vertices (packed in a vertex format) and indices (in
+// their index type) as they are uploaded, in page aligned sections of a versioned binary file.
+// Later runs map that file into memory and hand the sections straight to glBufferData: no parsing,
+// and no copy besides the one the driver makes. A baked mesh is keyed by the path, size and
+// modification time of its source file and by its vertex format, so that editing the source (or
+// selecting another format) simply misses the cache.
+namespace App::MeshCache {
+
+extern bool enabled;          // NOLINT
+extern std::string directory; // Where the baked meshes are stored -- NOLINT
+
+/// A baked mesh mapped into memory (read only, valid until `Close`)
+struct Mapping
+{
+    Mesh::VertexFormat format = Mesh::VertexFormat::Float;
+    std::span<std::byte const> vertices;
+    Mesh::PositionTransform transform;
+    GLenum indexType = GL_UNSIGNED_INT;
+    std::span<std::byte const> indices;
+
+    void *address = nullptr;
+    std::size_t length = 0;
+};
+
+/// Map the baked copy of a mesh file
+///
+/// @param source the mesh file the baked copy was made from
+/// @param format the vertex format the baked copy must have
+/// @param mapping the mapped mesh
+/// @return bool whether there is an up-to-date baked copy (a miss otherwise)
+bool Open(std::filesystem::path const &source, Mesh::VertexFormat format, Mapping &mapping);
+
+/// Unmap a baked mesh
+///
+/// @return void
+void Close(Mapping &mapping);
+
+/// Bake a mesh loaded from a mesh file
+///
+/// @param source the mesh file
+/// @param vertices the vertices, as they are uploaded
+/// @param indices the indices, as they are uploaded
+/// @return void
+void Store(std::filesystem::path const &source, Mesh::PackedVertices const &vertices,
+           Mesh::PackedIndices const &indices);
+
+/// Print the hit/miss counts
+void Dump(std::ostream &out);
+
+} // namespace App::MeshCache
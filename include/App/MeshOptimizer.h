@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include "glad/glad.h"
+
+#include "App/Mesh.h"
+
+// Index and vertex order optimization
+//
+// `Optimize` reorders the triangles of a mesh for the post-transform vertex cache with Tipsify
+// (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw",
+// 2007): triangles are emitted in fans around the vertices still in the cache. The fans come out in
+// clusters, split where the algorithm has to jump to an unrelated vertex; the clusters are then
+// sorted to draw the outward facing ones first, which reduces overdraw without making the cache
+// behave much worse. Finally the vertices are renumbered in the order of their first use, so that
+// the vertex fetch reads the vertex buffer mostly sequentially.
+namespace App::MeshOptimizer {
+
+// Entries of the simulated post-transform cache (FIFO), for the optimization and the statistics
+constexpr std::size_t cacheSize = 16;
+
+/// Post-transform cache efficiency of an index order
+struct Statistics
+{
+    double acmr; // Average cache miss ratio: vertices transformed per triangle (0.5 to 3)
+    double atvr; // Average transformed to vertex ratio: vertices transformed per vertex (1 at best)
+};
+
+/// Simulate the post-transform cache over the triangles
+///
+/// @param indices three per triangle
+/// @param vertexCount number of vertices the indices refer to
+/// @return Statistics the cache miss ratios
+Statistics Analyze(std::span<GLuint const> indices, std::size_t vertexCount);
+
+/// Reorder the triangles (vertex cache and overdraw) and the vertices (vertex fetch) of a mesh
+///
+/// @return void
+void Optimize(Mesh::Mesh &mesh);
+
+} // namespace App::MeshOptimizer
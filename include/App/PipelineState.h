@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+
+#include "glad/glad.h"
+
+// Immutable pipeline state objects
+//
+// A pipeline state bundles everything a draw call needs bound besides its buffers and uniforms:
+// the program (or program pipeline), the vertex layout, the depth, culling and blending state and
+// the viewport. States are created once and deduplicated (creating an equal description again
+// returns the same state), and are referred to by a compact 64-bit id.
+//
+// The id doubles as a draw sort key: its fields are ordered from the most to the least expensive
+// change (program, then vertex layout, then fixed-function state), so sorting draws by id groups
+// them to minimize state changes between them. `Apply` is the one place state changes are diffed.
+namespace App::PipelineState {
+
+/// What a pipeline state consists of
+struct Description
+{
+    GLuint program = 0;         // Monolithic program, or 0 with a program pipeline
+    GLuint programPipeline = 0; // Separable stage programs (only used when `program` is 0)
+    GLuint vertexArray = 0;     // Vertex layout (and buffers)
+
+    bool depthTest = false;
+    GLenum depthFunc = GL_LESS;
+    bool depthWrite = true;
+
+    bool cullFace = false;
+    GLenum cullMode = GL_BACK;
+    GLenum frontFace = GL_CCW;
+
+    bool blend = false;
+    GLenum blendSource = GL_ONE;
+    GLenum blendDestination = GL_ZERO;
+
+    std::array<GLint, 4> viewport{}; // x, y, width, height
+
+    bool operator==(Description const &) const = default;
+};
+
+// From the most significant bits: program (16 bits), vertex layout (16), fixed-function state and
+// viewport (16), state (16). Each field numbers the distinct values seen so far, starting at 1.
+using Id = std::uint64_t;
+
+constexpr Id invalidId = 0;
+
+/// The state with this description, created if there is none yet
+///
+/// @return Id the id of the state, invalidId if there are too many distinct states
+Id Create(Description const &description);
+
+/// @return Description const & the description of a state created by `Create`
+Description const &Get(Id id);
+
+/// Make a state current. Nothing is done if it is current already; otherwise each piece of state
+/// goes through StateCache, which only issues the calls that change something.
+///
+/// @return void
+void Apply(Id id);
+
+/// Forget which state is current (call after binding a program or vertex array directly)
+///
+/// @return void
+void Invalidate();
+
+/// Print the number of states and of applied and elided state changes
+///
+/// @return void
+void Dump(std::ostream &out);
+
+} // namespace App::PipelineState
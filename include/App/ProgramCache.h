@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+#include "glad/glad.h"
+
+// On-disk cache of linked program binaries (glGetProgramBinary/glProgramBinary, core since 4.1)
+//
+// A program is stored under a key hashing its shader sources together with GL_RENDERER and
+// GL_VERSION, so that a driver update or another GPU simply misses the cache. Loading falls back to
+// compiling from source (the caller's job) whenever anything does not match or the driver rejects
+// the binary.
+namespace App::ProgramCache {
+
+extern bool enabled;          // NOLINT
+extern std::string directory; // Where the binaries are stored -- NOLINT
+
+/// Key of a program made of the given shader sources (requires a current OpenGL context)
+std::uint64_t Key(std::string_view vertexShaderSource, std::string_view fragmentShaderSource);
+
+/// Create a program from its cached binary
+///
+/// @param separable whether the program was linked as a separable (single stage) program
+/// @return GLuint the linked program, 0 on a miss or if the binary could not be loaded
+GLuint Load(std::uint64_t key, bool separable = false);
+
+/// Store the binary of a linked program (created with GL_PROGRAM_BINARY_RETRIEVABLE_HINT)
+///
+/// @return void
+void Store(std::uint64_t key, GLuint program);
+
+/// Print the hit/miss counts
+void Dump(std::ostream &out);
+
+} // namespace App::ProgramCache
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+
+#include "App/Shader.h"
+
+// Feature variants (permutations) of the graphics pipeline program
+//
+// A permutation is a set of features; each enabled feature `NAME` is compiled in as
+// `#define USE_NAME` (see the `#ifdef USE_...` sections of the shaders). Programs are built on
+// first use (through the program binary cache) and kept in memory up to `budget` programs, the
+// least recently used one being deleted past it. The permutations used during a run can be saved
+// to a list file and built up front on the next run, as one batch.
+//
+// With `separable` set, each stage is built as its own separable program, depending only on the
+// features of that stage, and the stage programs are combined by program pipeline objects: N vertex
+// variants x M fragment variants take N + M programs instead of N * M. Stage programs and pipelines
+// are small and stay in memory until `Clear`.
+namespace App::ProgramPermutations {
+
+using Key = std::uint32_t;
+
+/// Features of the pipeline shaders (bits of a `Key`)
+enum Feature : Key
+{
+    VertexColor = 1U << 0, // Color from the vertex attribute (white otherwise)
+    Instancing = 1U << 1,  // Draw all the objects with one instanced draw call
+    Fog = 1U << 2,         // Fade to the fog color with depth
+    FeatureCount = 3,
+};
+
+/// Features that affect each stage
+constexpr Key vertexFeatures = VertexColor | Instancing;
+constexpr Key fragmentFeatures = Fog;
+
+/// A separable permutation: a program per stage, combined by a program pipeline object
+struct Pipeline
+{
+    GLuint pipeline = 0;
+    GLuint vertexProgram = 0;
+    GLuint fragmentProgram = 0;
+};
+
+extern std::size_t budget; // Maximum number of programs kept in memory -- NOLINT
+extern bool separable;     // Build separable stage programs and pipelines -- NOLINT
+
+/// Parse a comma or space separated list of feature names (e.g. "vertex_color,fog")
+///
+/// @return bool whether all the names are valid
+bool ParseFeatures(std::string const &names, Key &key);
+
+/// The macros defining the features of a permutation, e.g. {"USE_VERTEX_COLOR", "USE_FOG"}
+std::vector<std::string> Defines(Key key);
+
+/// The macros defining one stage of a permutation built as a separable program: the features of
+/// that stage, and SEPARABLE
+///
+/// @param stage GL_VERTEX_SHADER or GL_FRAGMENT_SHADER
+std::vector<std::string> StageDefines(GLenum stage, Key key);
+
+/// Sources of a permutation, with its features defined
+///
+/// @return App::Shader::Sources the vertex and fragment shader sources
+App::Shader::Sources LoadSources(Key key);
+
+/// Source of one stage of a permutation built as a separable program: only the features of that
+/// stage are defined, along with SEPARABLE
+///
+/// @param stage GL_VERTEX_SHADER or GL_FRAGMENT_SHADER
+/// @return std::string the source
+std::string LoadStageSource(GLenum stage, Key key);
+
+/// Name of a permutation as written to the list files, e.g. "VERTEX_COLOR,FOG" ("none" for 0)
+std::string ToString(Key key);
+
+/// Build a program: reuse the binary linked by a previous run if the driver accepts it, otherwise
+/// compile from source and store the result for the next run
+///
+/// @return GLuint the program, 0 on failure
+GLuint Build(App::Shader::Sources const &sources);
+
+/// The program of a permutation, built if it is not in memory
+///
+/// @return GLuint the program, 0 if it failed to build
+GLuint Get(Key key);
+
+/// The program pipeline of a permutation, building the missing stage programs (`separable` mode)
+///
+/// @return Pipeline the pipeline, all 0 if a stage failed to build
+Pipeline GetPipeline(Key key);
+
+/// Build the stage programs of a permutation again from the current sources (e.g. after they were
+/// edited) and, if both build, replace all the stage programs and pipelines with them. Unbind the
+/// current pipeline first.
+///
+/// @return Pipeline the new pipeline, all 0 if a stage failed to build (nothing is replaced)
+Pipeline RebuildPipeline(Key key);
+
+/// Add a program built elsewhere (e.g. by the shader hot reload) as the program of a permutation
+///
+/// @return void
+void Insert(Key key, GLuint program);
+
+/// Build the permutations (or pipelines in `separable` mode) listed in a file (as saved by
+/// `SaveUsed`) in one batch. A missing file is not an error.
+///
+/// @return void
+void Prewarm(std::string const &listPath);
+
+/// Save the permutations requested during this run, one per line
+///
+/// @return void
+void SaveUsed(std::string const &listPath);
+
+/// Delete all the programs, stage programs and pipelines (e.g. after the shader sources changed).
+/// Unbind them first.
+///
+/// @return void
+void Clear();
+
+/// Print the hit/miss/eviction counts
+///
+/// @return void
+void Dump(std::ostream &out);
+
+} // namespace App::ProgramPermutations
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+#include "glad/glad.h"
+
+#include "App/Hash.h"
+
+// Program reflection and uniform value shadowing
+//
+// `Reflect` queries the active uniforms, uniform blocks and vertex attributes of a program once,
+// after linking, into a flat open-addressing hash table keyed by program and name hash. Lookups use
+// ids hashed from the names at compile time (`Id("u_offset")`), so no string reaches OpenGL (or is
+// even hashed) on the hot path.
+//
+// Each uniform also keeps the last value set through `SetUniform`: setting the same value again
+// issues no call. Values are set with glProgramUniform*, which does not require the program to be
+// bound. Setting a uniform behind this layer's back leaves a stale shadow value.
+namespace App::ProgramReflection {
+
+enum class Kind : std::uint8_t
+{
+    Uniform,
+    UniformBlock,
+    Attribute,
+};
+
+/// What is known about an active resource of a program
+struct Resource
+{
+    Kind kind;
+    GLenum type;      // Uniforms and attributes
+    GLint size;       // Array size (1 if not an array); data size in bytes for uniform blocks
+    GLint location;   // -1 for a uniform inside a block; block index for uniform blocks
+    GLint blockIndex; // Block of a uniform, -1 in the default block
+};
+
+/// Id of a resource name (array names without their "[0]" suffix)
+constexpr std::uint64_t Id(std::string_view name)
+{
+    return App::Fnv1a64(name);
+}
+
+/// Query and store the active resources of a linked program
+///
+/// @return void
+void Reflect(GLuint program);
+
+/// Drop the resources of a program (call before deleting it)
+///
+/// @return void
+void Forget(GLuint program);
+
+/// @return Resource const * the resource, nullptr if the program has no such active resource
+Resource const *Find(GLuint program, Kind kind, std::uint64_t id);
+
+/// @return GLint the location of a uniform, -1 if it is not active
+GLint UniformLocation(GLuint program, std::uint64_t id);
+
+/// @return GLint the location of a vertex attribute, -1 if it is not active
+GLint AttributeLocation(GLuint program, std::uint64_t id);
+
+/// @return GLuint the index of a uniform block, GL_INVALID_INDEX if it is not active
+GLuint UniformBlockIndex(GLuint program, std::uint64_t id);
+
+/// Set a uniform of the default block unless it already has this value. Uniforms that are not
+/// active (e.g. optimized out of a permutation) are ignored.
+void SetUniform(GLuint program, std::uint64_t id, GLint value);
+void SetUniform(GLuint program, std::uint64_t id, GLfloat value);
+void SetUniform(GLuint program, std::uint64_t id, std::array<GLfloat, 2> const &value);
+void SetUniform(GLuint program, std::uint64_t id, std::array<GLfloat, 3> const &value);
+void SetUniform(GLuint program, std::uint64_t id, std::array<GLfloat, 4> const &value);
+void SetUniform(GLuint program, std::uint64_t id, std::array<GLfloat, 16> const &value); // mat4
+
+/// Print the number of issued and elided uniform updates
+///
+/// @return void
+void Dump(std::ostream &out);
+
+} // namespace App::ProgramReflection
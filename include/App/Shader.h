@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+#include "glad/glad.h"
+
+// Shader compilation
+//
+// Building a program is split in two so that many programs can be compiled at once: `Submit` only
+// issues the compile and link commands and never asks for a status (any status query waits for the
+// compiler), `Finish` checks the statuses once the program is actually needed. Submit every program
+// first, then finish them. With GL_KHR_parallel_shader_compile (or its ARB twin) the driver
+// compiles on its own threads in the meantime, and `IsReady` tells without blocking whether
+// `Finish` would wait.
+namespace App::Shader {
+
+/// Sources of the shaders of a program
+struct Sources
+{
+    std::string vertex;
+    std::string fragment;
+};
+
+/// A program submitted for compilation whose status has not been checked yet
+struct PendingProgram
+{
+    GLuint program = 0;
+    std::array<GLuint, 2> shaders{}; // Shaders (0 if unused), deleted by `Finish`
+};
+
+/// Enable parallel shader compilation when the driver supports it (requires a current context)
+///
+/// @return void
+void Initialize();
+
+/// Whether the driver compiles on background threads (`Initialize` must have been called)
+bool ParallelCompileSupported();
+
+/// Start compiling and linking a program
+///
+/// @param vertexShaderSource Vertex shader source code
+/// @param fragmentShaderSource Fragment shader source code
+/// @return PendingProgram the program to pass to `Finish`
+PendingProgram Submit(std::string const &vertexShaderSource,
+                      std::string const &fragmentShaderSource);
+
+/// Start compiling and linking a separable program made of a single stage, to be combined with
+/// other stages in a program pipeline object
+///
+/// @param type GL_VERTEX_SHADER or GL_FRAGMENT_SHADER
+/// @param source The shader source code
+/// @return PendingProgram the program to pass to `Finish`
+PendingProgram SubmitStage(GLenum type, std::string const &source);
+
+/// Whether `Finish` would return without waiting for the compiler (always true without parallel
+/// compilation, as there is no way to tell)
+bool IsReady(PendingProgram const &pending);
+
+/// Check the compile and link statuses of a submitted program, print the logs on failure and
+/// release its shader objects
+///
+/// @return GLuint the linked program, 0 on failure
+GLuint Finish(PendingProgram &pending);
+
+/// Compile and link a program right away (`Submit` + `Finish`)
+///
+/// @return GLuint the linked program, 0 on failure
+GLuint CreateProgram(std::string const &vertexShaderSource,
+                     std::string const &fragmentShaderSource);
+
+} // namespace App::Shader
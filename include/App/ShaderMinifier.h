@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// GLSL minification
+//
+// Strips the comments and the whitespace the compiler does not need, and resolves the conditional
+// sections it can: the macros defined by the source itself (including the ones ShaderSource
+// injects) are tracked, and the code under a condition that is false is dropped, together with the
+// `#if`/`#endif` lines. Conditions that cannot be evaluated (e.g. on a macro defined by a section
+// that is kept as is) are left to the compiler. `#line` directives are dropped, so compiler errors
+// in a minified source point at the minified lines: minify sources that were validated (see
+// tools/ShaderTool.cpp).
+namespace App::ShaderMinifier {
+
+/// Minify a shader source
+///
+/// @param source a complete shader source (includes resolved)
+/// @return std::string the minified source
+std::string Minify(std::string_view source);
+
+} // namespace App::ShaderMinifier
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Shader source loading
+//
+// Shaders are named relative to the shaders directory (e.g. "vert.glsl") and are read from the
+// copies embedded into the binary (see EmbeddedShaders.h), unless `directory` is set: disk loading
+// is an override, for hot reload and for trying out shaders without rebuilding. The build embeds
+// every permutation the application loads already preprocessed and minified (see `make shaders`),
+// under its `PrebuiltName`: loading one is a lookup. Anything else embedded is resolved as below.
+//
+// Files are read in one go and `#include "file"` directives (relative to the including file) are
+// resolved, with `#line` directives so that compiler errors point at the right file and line (the
+// source string number is the index of the file in the order it was first read, 0 being the loaded
+// file). Resolved sources are memoized by name: a later load only checks the modification time of
+// the file and of everything it includes (nothing for embedded ones). Every file read is memoized
+// too, with its modification time and the positions of its includes, so a header shared by several
+// shaders is read and parsed once, and only again once it changes. Thread-safe (the shader watcher
+// loads sources on its own thread).
+namespace App::ShaderSource {
+
+extern std::string directory; // Read the shaders from here (empty: embedded), set first -- NOLINT
+
+/// Load a shader with its includes resolved, injecting `#define`s right after `#version`
+///
+/// @param name the shader file, relative to the shaders directory
+/// @param defines macros to define, either "NAME" or "NAME VALUE"
+/// @return std::string the source, empty if it (or one of its includes) could not be read
+std::string Load(std::filesystem::path const &name, std::vector<std::string> const &defines = {});
+
+/// Name of the embedded prebuilt source of a shader with these defines, e.g. "vert.USE_FOG.glsl"
+/// ("vert.none.glsl" without any)
+///
+/// @return std::string the name, relative to the shaders directory
+std::string PrebuiltName(std::filesystem::path const &name,
+                         std::vector<std::string> const &defines);
+
+/// Forget all memoized sources
+///
+/// @return void
+void Clear();
+
+/// Print the memoization hit/miss counts
+///
+/// @return void
+void Dump(std::ostream &out);
+
+} // namespace App::ShaderSource
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "App/Shader.h"
+
+// Shader hot reload
+//
+// A background thread watches a directory with inotify. After a file in it is written (or replaced
+// by an editor renaming a temporary file over it), the thread reads the sources again with the
+// given loader, off the render thread, and wakes up the main loop (`App::MarkDirty`). The render
+// thread picks the new sources up at a frame boundary with `TakeSources` and compiles them itself,
+// since only it owns the OpenGL context.
+namespace App::ShaderWatcher {
+
+/// Start watching `directory`; `load` is called on the watcher thread after each change
+///
+/// @return bool whether the directory could be watched
+bool Start(std::string const &directory, std::function<App::Shader::Sources()> load);
+
+/// Stop the watcher thread (does nothing if it is not running)
+///
+/// @return void
+void Stop();
+
+/// Take the sources loaded after the latest change, if they were not taken yet
+///
+/// @param sources receives the new sources
+/// @return bool whether there were new sources
+bool TakeSources(App::Shader::Sources &sources);
+
+} // namespace App::ShaderWatcher
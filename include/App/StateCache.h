@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+#include "glad/glad.h"
+
+// Shadow copy of the OpenGL state on the CPU
+//
+// Each function issues the corresponding OpenGL call only when it changes the current state; the
+// call is elided otherwise. This only works if every change of the tracked state goes through this
+// layer: after code that changes it behind the cache's back, call `Invalidate`.
+namespace App::StateCache {
+
+/// Kinds of cached calls (for the issued/elided counters)
+enum class Call : std::uint8_t
+{
+    EnableDisable,
+    Viewport,
+    ClearColor,
+    UseProgram,
+    BindVertexArray,
+    BindProgramPipeline,
+    DepthFunc,
+    DepthMask,
+    CullFace,
+    FrontFace,
+    BlendFunc,
+    Count,
+};
+
+struct Counters
+{
+    unsigned long long issued = 0;
+    unsigned long long elided = 0;
+};
+
+void Enable(GLenum capability);
+void Disable(GLenum capability);
+void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void UseProgram(GLuint program);
+void BindVertexArray(GLuint vertexArray);
+void BindProgramPipeline(GLuint pipeline); // Only used while no program is current (UseProgram(0))
+void DepthFunc(GLenum func);
+void DepthMask(GLboolean flag);
+void CullFace(GLenum mode);
+void FrontFace(GLenum mode);
+void BlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+
+/// Forget the shadowed state: the next call of each kind is issued
+void Invalidate();
+
+/// Issued/elided counts of one kind of call
+Counters GetCounters(Call call);
+
+void ResetCounters();
+
+/// Print the issued/elided counters of every kind of call
+void Dump(std::ostream &out);
+
+char const *CallName(Call call);
+
+} // namespace App::StateCache
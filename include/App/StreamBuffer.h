@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <string_view>
+
+#include "glad/glad.h"
+
+// Buffers the CPU writes again every frame (dynamic geometry)
+//
+// A ring is one buffer object written front to back. In `Mode::Unsynchronized`, each allocation is
+// mapped with GL_MAP_UNSYNCHRONIZED_BIT, so the driver never waits for the GPU to finish reading
+// the buffer (an implicit sync) nor copies it; instead the allocations of a frame are fenced
+// (glFenceSync) at the end of the frame, and an allocation that would overwrite a range of a frame
+// still in flight waits for that frame's fence first (glClientWaitSync), which the statistics
+// report. `Mode::Orphaning` is the fallback that needs no fences: when the ring is full, its
+// storage is re-specified (glBufferData with no data), which lets the driver hand out fresh memory
+// while the GPU still reads the old one.
+namespace App::StreamBuffer {
+
+enum class Mode : std::uint8_t
+{
+    Unsynchronized, // Unsynchronized mappings, fenced per frame
+    Orphaning,      // Unsynchronized mappings, storage re-specified whenever the ring is full
+};
+
+/// The range written during a frame, and the fence signaled once the GPU is done with it. The range
+/// goes from `start` to `end` in ring order: it wraps around when `end <= start`.
+struct FencedRange
+{
+    GLsync fence;
+    GLintptr start;
+    GLintptr end;
+};
+
+struct Ring
+{
+    GLenum target = GL_ARRAY_BUFFER;
+    GLuint buffer = 0;
+    GLsizeiptr size = 0;
+    Mode mode = Mode::Unsynchronized;
+
+    GLintptr head = 0;         // Where the next allocation starts
+    GLintptr frameStart = 0;   // Where the allocations of the current frame start
+    bool frameWrapped = false; // Whether the allocations of the current frame wrapped around
+    std::deque<FencedRange> inFlight; // Oldest first
+};
+
+/// Space of a ring mapped for writing
+struct Allocation
+{
+    void *pointer = nullptr;
+    GLintptr offset = 0; // In the buffer
+};
+
+/// Create the buffer of a ring (requires a current OpenGL context)
+///
+/// @param ring the ring
+/// @param target the target the buffer is used with (e.g. GL_ARRAY_BUFFER)
+/// @param size the size of the ring, typically a few frames' worth of data
+/// @param mode how the writes are synchronized with the GPU
+/// @return void
+void Create(Ring &ring, GLenum target, GLsizeiptr size, Mode mode);
+
+/// Delete the buffer of a ring
+///
+/// @return void
+void Destroy(Ring &ring);
+
+/// Map space for `size` bytes, waiting for the GPU if it still uses that space. The buffer is left
+/// bound to the target of the ring. An allocation larger than the ring grows it. If the
+/// allocations of one frame do not fit in the ring, it is orphaned: the data of the frame's
+/// previous allocations must have been drawn already.
+///
+/// @param alignment of the offset of the allocation (e.g. the vertex size)
+/// @return Allocation where to write the data (a null pointer if the buffer could not be mapped,
+/// in which case it must not be unmapped)
+Allocation Map(Ring &ring, GLsizeiptr size, GLsizeiptr alignment);
+
+/// Unmap the space of the last allocation, before the draw calls that read it
+///
+/// @return void
+void Unmap(Ring &ring);
+
+/// Fence the allocations of the frame, after the draw calls that read them
+///
+/// @return void
+void EndFrame(Ring &ring);
+
+/// Print the allocation, wait and orphaning statistics of all the rings
+void Dump(std::ostream &out);
+
+/// Parse a mode name ("unsynchronized" or "orphaning")
+///
+/// @return bool whether the name is valid (an error is printed otherwise)
+bool ParseMode(std::string_view name, Mode &mode);
+
+char const *ToString(Mode mode);
+
+} // namespace App::StreamBuffer
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+// Timeline tracing
+//
+// TRACE_SCOPE("name") records when the enclosing scope is entered and left. The zones of every
+// thread are written as Chrome trace-event JSON (open in chrome://tracing or ui.perfetto.dev) by
+// TRACE_WRITE(path), typically at shutdown.
+//
+// Tracing is compiled in only when APP_TRACE is defined (`make TRACE=1`), otherwise the macros
+// expand to nothing. Zone names must be string literals (only the pointer is stored).
+
+#ifdef APP_TRACE
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#define TRACE_SCOPE(name) App::Trace::Zone const TRACE_CONCAT(traceZone, __LINE__){name}
+#define TRACE_WRITE(path) App::Trace::WriteChromeTrace(path)
+
+#else
+
+#define TRACE_SCOPE(name) static_cast<void>(0)
+#define TRACE_WRITE(path) static_cast<void>(0)
+
+#endif
+
+namespace App::Trace {
+
+/// Nanoseconds since the start of the process
+std::uint64_t Now();
+
+/// Append a complete zone to the calling thread's buffer (lock-free, dropped when the buffer is
+/// full)
+void Record(char const *name, std::uint64_t begin, std::uint64_t end);
+
+/// Write the zones of all threads to `path` in the Chrome trace-event format
+///
+/// @return bool whether the file could be written
+bool WriteChromeTrace(char const *path);
+
+/// Records the lifetime of a scope as a zone (use through TRACE_SCOPE)
+struct Zone
+{
+    explicit Zone(char const *name) : name{name}, begin{Now()}
+    {
+    }
+
+    ~Zone()
+    {
+        Record(name, begin, Now());
+    }
+
+    Zone(Zone const &) = delete;
+    Zone &operator=(Zone const &) = delete;
+    Zone(Zone &&) = delete;
+    Zone &operator=(Zone &&) = delete;
+
+private:
+    char const *name;
+    std::uint64_t begin;
+};
+
+} // namespace App::Trace
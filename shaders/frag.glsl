@@ -10,6 +10,15 @@ in vec3 v_vertexColor;
 
 out vec4 color;
 
+#ifdef USE_FOG
+const vec3 fogColor = vec3(0.5f, 0.5f, 0.55f);
+#endif
+
 void main() {
     color = vec4(v_vertexColor.r, v_vertexColor.g, v_vertexColor.b, 1.0f);
+
+#ifdef USE_FOG
+    // Fade to the fog color with depth (window space depth: 0 at the near plane, 1 at the far one)
+    color.rgb = mix(color.rgb, fogColor, gl_FragCoord.z);
+#endif
 }
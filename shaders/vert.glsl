@@ -15,10 +15,44 @@ layout(location=1) in vec3 vertexColor;
 
 out vec3 v_vertexColor; // (convection) v_: coming from vertex shader
 
+#ifdef SEPARABLE
+// Built as a separable program (see ProgramPermutations): the outputs that the next stage reads
+// from a different program must be declared
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+#endif
+
+// Translation of the geometry in normalized device coordinates
+uniform vec2 u_offset;
+
+// Dequantization of the positions (identity for float vertices, see Mesh::Pack)
+uniform vec3 u_positionScale;
+uniform vec3 u_positionOffset;
+
+// Features are enabled by the application with #defines (see ProgramPermutations)
+
+#ifdef USE_INSTANCING
+// Distance between two consecutive instances along x (all the instances are drawn in place by
+// default, like the objects of the non-instanced draw loop)
+#ifndef INSTANCE_SPACING
+#define INSTANCE_SPACING 0.0
+#endif
+#endif
+
 void main() {
+    vec3 position = vertexPosition * u_positionScale + u_positionOffset + vec3(u_offset, 0.0f);
+#ifdef USE_INSTANCING
+    position.x += float(gl_InstanceID) * INSTANCE_SPACING;
+#endif
+
     // (x, y, z, w)
-    gl_Position = vec4(vertexPosition, 1.0f);
+    gl_Position = vec4(position, 1.0f);
 
     // Sent the color down to the pipeline
+#ifdef USE_VERTEX_COLOR
     v_vertexColor = vertexColor;
+#else
+    v_vertexColor = vec3(1.0f);
+#endif
 }
@@ -1,6 +1,13 @@
 #include <algorithm>
-#include <fstream>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
 #include <iostream>
+#include <numbers>
 #include <string>
 #include <vector>
 
@@ -8,6 +15,23 @@
 #include "glad/glad.h"
 
 #include "App/App.h"
+#include "App/FramePacer.h"
+#include "App/FrameStats.h"
+#include "App/GLCheck.h"
+#include "App/GLRecorder.h"
+#include "App/GpuTimer.h"
+#include "App/MeshCache.h"
+#include "App/MeshOptimizer.h"
+#include "App/PipelineState.h"
+#include "App/ProgramCache.h"
+#include "App/ProgramPermutations.h"
+#include "App/ProgramReflection.h"
+#include "App/Shader.h"
+#include "App/ShaderSource.h"
+#include "App/ShaderWatcher.h"
+#include "App/StateCache.h"
+#include "App/StreamBuffer.h"
+#include "App/Trace.h"
 
 namespace App {
 
@@ -21,8 +45,8 @@ struct NormalizedColor
 
 constexpr NormalizedColor bg = {0.0F, 0.0F, 1.F, 1.0F};
 
-constexpr int screenHeight = 480;
-constexpr int screenWidth = 640;
+int screenHeight = 480; // NOLINT
+int screenWidth = 640;  // NOLINT
 
 SDL_Window *graphicsApplicationWindow = nullptr; // NOLINT
 SDL_GLContext openGLContext = nullptr;           // NOLINT
@@ -46,6 +70,12 @@ GLuint indexBufferObject = 0; // NOLINT
 // OpenGL draw calls
 GLuint graphicsPipelineShaderProgram = 0; // NOLINT
 
+// Number of indices of the mesh (and their type), and the number of times it is drawn per frame
+GLsizei indexCount = 0;               // NOLINT
+GLenum indexType = GL_UNSIGNED_INT;   // NOLINT
+unsigned long objectCount = 1;        // NOLINT
+unsigned long long drawCallCount = 0; // NOLINT
+
 /* At a minimum, every Modern OpenGL program needs a vertex and fragment shader
    OpenGL provides functions that will compile the shader source code (stored as strings) at
    run-time. */
@@ -53,10 +83,90 @@ GLuint graphicsPipelineShaderProgram = 0; // NOLINT
 // If true we quit the main loop
 bool quit = false; // NOLINT
 
+// Headless (offscreen) rendering
+// When set before `Initialize`, no visible window is created and all rendering goes into the
+// offscreen framebuffer object below instead of the window's default framebuffer.
+bool headless = false;           // NOLINT
+GLuint offscreenFramebuffer = 0; // NOLINT
+GLuint offscreenColorBuffer = 0; // NOLINT
+GLuint offscreenDepthBuffer = 0; // NOLINT
+
+unsigned long frameLimit = 0; // NOLINT
+unsigned long frameCount = 0; // NOLINT
+
+LoopMode loopMode = LoopMode::Continuous; // NOLINT
+
+// Whether something changed since the last rendered frame (the first frame is always rendered)
+std::atomic<bool> sceneDirty{true}; // NOLINT
+
+// SDL event type used to wake up a main loop waiting for events (registered in `Initialize`, ~0
+// until then)
+Uint32 wakeUpEventType = ~0U; // NOLINT
+
+SwapInterval swapInterval = SwapInterval::On; // NOLINT
+double targetFrameRate = 0.0;                 // NOLINT
+bool animate = false;                         // NOLINT
+
+// OpenGL command stream capture (see GLRecorder)
+char const *glCapturePath = nullptr; // NOLINT
+
+// Dynamic geometry (see StreamBuffer)
+bool streamVertices = false;                                        // NOLINT
+StreamBuffer::Mode streamMode = StreamBuffer::Mode::Unsynchronized; // NOLINT
+
+// Mesh file rendered instead of the built-in quad (see Mesh)
+char const *meshPath = nullptr;                                  // NOLINT
+Mesh::VertexFormat meshVertexFormat = Mesh::VertexFormat::Snorm16; // NOLINT
+
+// Shader hot reload (see ShaderWatcher)
+bool hotReload = false; // NOLINT
+
+// Shader features of the graphics pipeline (see ProgramPermutations)
+std::uint32_t shaderFeatures = ProgramPermutations::VertexColor; // NOLINT
+char const *permutationListPath = nullptr;                       // NOLINT
+
 } // namespace App
 
 namespace {
 
+/// The state advanced by the simulation, in fixed time steps independent of the frame rate
+struct SimulationState
+{
+    double time = 0.0;         // Simulated time in seconds
+    GLfloat brightness = 1.0F; // Of the background (pulses when animating)
+    GLfloat sway = 0.0F;       // Horizontal offset of the geometry (sways when animating)
+};
+
+// Duration of one simulation step (the simulation runs at 60 Hz whatever the frame rate)
+constexpr double simulationStep = 1.0 / 60.0;
+
+// Longest real time a single frame may simulate. After a hitch (or idling) the simulation skips
+// ahead instead of running a burst of catch-up steps that would make the next frame late too.
+constexpr double maxFrameTime = 0.25;
+
+// The two most recent simulation states, and the real time not simulated yet
+SimulationState previousState{};    // NOLINT
+SimulationState currentState{};     // NOLINT
+double simulationAccumulator = 0.0; // NOLINT
+
+// What is rendered: interpolated between the two most recent states, so that motion is smooth even
+// when the frame rate is not a multiple of the simulation rate
+SimulationState renderState{}; // NOLINT
+
+// The program pipeline of the graphics pipeline with separable shaders (see ProgramPermutations)
+App::ProgramPermutations::Pipeline graphicsProgramPipeline{}; // NOLINT
+
+// Everything the draw calls of the graphics pipeline need bound (see PipelineState)
+App::PipelineState::Id graphicsPipelineState = App::PipelineState::invalidId; // NOLINT
+
+// Dequantization of the positions of the mesh in the vertex buffer (see VertexSpecification)
+App::Mesh::PositionTransform meshPositionTransform{}; // NOLINT
+
+// With `streamVertices`: the vertices of the mesh, uploaded again every frame through the ring
+App::StreamBuffer::Ring vertexStream{};                                  // NOLINT
+std::vector<std::byte> streamedVertices;                                 // NOLINT
+App::Mesh::VertexFormat streamedFormat = App::Mesh::VertexFormat::Float; // NOLINT
+
 void GetOpenGLVersionInfo()
 {
     std::cout << "Vendor: " << glGetString(GL_VENDOR) << std::endl;
@@ -65,192 +175,155 @@ void GetOpenGLVersionInfo()
     std::cout << "Shading Language: " << glGetString(GL_SHADING_LANGUAGE_VERSION) << std::endl;
 }
 
-/// Clear the error state until no error exists.
-/// This is because in OpenGL and a call to glGetError no other error is recorded until.
-/// 1. glGetError is called,
-/// 2. the error code is returned,
-/// 3. the flag is set to GL_NO_ERROR.
+/// Create a framebuffer object (with a color and a depth attachment) of the size of the screen and
+/// bind it, so that all subsequent rendering goes into it instead of the default framebuffer.
+/// This is used in headless mode where there is no (visible) window to render to.
 ///
 /// @return void
-void GLClearAllErrors()
+void CreateOffscreenFramebuffer()
 {
-    // GL_NO_ERROR: no error has been recorded
-    while (glGetError() != GL_NO_ERROR)
+    // Renderbuffers are the natural choice for attachments we never sample from
+    glGenRenderbuffers(1, &App::offscreenColorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, App::offscreenColorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, App::screenWidth, App::screenHeight);
+
+    glGenRenderbuffers(1, &App::offscreenDepthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, App::offscreenDepthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, App::screenWidth,
+                          App::screenHeight);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &App::offscreenFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, App::offscreenFramebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                              App::offscreenColorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER,
+                              App::offscreenDepthBuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
     {
-
+        std::cerr << "Offscreen framebuffer is incomplete." << std::endl;
+        exit(5); // NOLINT
     }
+
+    // The framebuffer stays bound for the whole lifetime of the application
 }
 
-/// Check if an error has occured and return the error code and show where it happend.
-/// This function is usually called after a call to some OpenGL function (starting with gl).
+/// Read the sources of the graphics pipeline (also called on the shader watcher thread)
 ///
-/// @param funcName name of the function in which the error has happened
-/// @param lineNo line number at which the error has happend
-/// @return bool whether any error has occurred or not
-bool GLCheckErrorStatus(const char* funcName, int lineNo)
+/// @return App::Shader::Sources the vertex and fragment shader sources
+App::Shader::Sources LoadPipelineSources()
 {
-    while (GLenum error = glGetError()) {
-        std::cerr << "OpenGL Error: " << error
-                  << "\n\tLine: " << lineNo
-                  << "\n\tFunction: " << funcName
-                  << '\n' << std::endl;
-        return true;
-    }
-
-    // error was 0 (GL_NO_ERROR)
-    return false;
+    return App::ProgramPermutations::LoadSources(App::shaderFeatures);
 }
 
-/// Wraps call to OpenGL functions. First clears any previously set error state,
-/// then it executes the function call, and finally checks for the errors,
-/// passing the string of the function call (#X) and the line number (__LINE__)
-/// at which the error has happened.
+/// Create (or find) the pipeline state of the current graphics pipeline
 ///
-/// @param X function call including function name all its parameters
-#define GLCall(X)                               \
-    GLClearAllErrors();                         \
-    X;                                          \
-    GLCheckErrorStatus(#X, __LINE__);
-
-std::string LoadShaderAsString(std::string const &filepath)
+/// @return void
+void CreatePipelineState()
 {
-    // Holds the returning shader program string
-    std::string src{};
-
-    std::string line;
-    std::ifstream file(filepath);
-    if (file.is_open())
+    App::PipelineState::Description description{};
+    description.program = App::graphicsPipelineShaderProgram;
+    if (App::ProgramPermutations::separable)
     {
-        while (std::getline(file, line))
-        {
-            src += line + '\n';
-        }
-
-        file.close();
+        description.program = 0;
+        description.programPipeline = graphicsProgramPipeline.pipeline;
     }
+    description.vertexArray = App::vertexArrayObject;
 
-    return src;
+    // Depth test and face culling disabled
+    description.depthTest = false;
+    description.cullFace = false;
+    description.viewport = {0, 0, App::screenWidth, App::screenHeight};
+
+    graphicsPipelineState = App::PipelineState::Create(description);
 }
 
-/// Compiles any valid vertex, fragment, geometry, tessellation or compute shader.
+/// Swap in the shaders edited since the previous frame, if any. A program that fails to build is
+/// reported and the current one is kept.
 ///
-/// @param type Determine which shader to compile
-/// @param source The shader source code
-/// @return id of the shader object (0 on failure)
-GLuint CompileShader(GLenum type, std::string const &source)
+/// @return void
+void ReloadGraphicsPipeline()
 {
-    // Create shader object
-    GLuint shaderObject = 0;
-    shaderObject = glCreateShader(type);
+    App::Shader::Sources sources;
+    if (!App::ShaderWatcher::TakeSources(sources))
+    {
+        return;
+    }
 
-    // Specify the shader source code for the object
-    char const *src = source.c_str();
-    glShaderSource(shaderObject, 1, &src, nullptr);
+    TRACE_SCOPE("ReloadGraphicsPipeline");
 
-    // Compile the shader object
-    glCompileShader(shaderObject);
+    // Unbinding the programs to delete (and validating new ones) changes the bindings behind the
+    // pipeline state's back
+    App::PipelineState::Invalidate();
 
-    // Check for compilation errors
-    GLint success = GL_FALSE;
-    glGetShaderiv(shaderObject, GL_COMPILE_STATUS, &success);
-    if (success == GL_FALSE)
+    if (App::ProgramPermutations::separable)
     {
-        std::array<char, MAX_GL_INFO_LOG_LEN> infoLog = {0};
-        glGetShaderInfoLog(shaderObject, MAX_GL_INFO_LOG_LEN, nullptr, infoLog.data());
-        std::cerr << "ERROR::SHADER::COMPILATION_FAILED\n" << infoLog.data() << std::endl;
+        // The watcher has read the files already (and ShaderSource memoized them); each stage is
+        // built from its own permutation of them
+        App::StateCache::BindProgramPipeline(0);
+        App::ProgramPermutations::Pipeline const pipeline =
+            App::ProgramPermutations::RebuildPipeline(App::shaderFeatures);
+        if (pipeline.pipeline == 0)
+        {
+            std::cerr << "Shader reload failed, keeping the previous program" << std::endl;
+            return;
+        }
 
-        // Delete broken shader object
-        glDeleteShader(shaderObject);
+        graphicsProgramPipeline = pipeline;
+        CreatePipelineState();
+        std::cout << "Shaders reloaded" << std::endl;
+        return;
+    }
 
-        return 0;
+    GLuint const program = App::ProgramPermutations::Build(sources);
+    if (program == 0)
+    {
+        std::cerr << "Shader reload failed, keeping the previous program" << std::endl;
+        return;
     }
 
-    return shaderObject;
+    // All the other permutations are out of date too. Unbind through the state cache first, so
+    // that it does not keep a deleted name as current.
+    App::StateCache::UseProgram(0);
+    App::ProgramPermutations::Clear();
+    App::ProgramPermutations::Insert(App::shaderFeatures, program);
+    App::graphicsPipelineShaderProgram = program;
+    CreatePipelineState();
+    std::cout << "Shaders reloaded" << std::endl;
 }
 
-/// Creates a graphics program object (i.e. graphics pipeline) with a vertex shader and a fragment
-/// shader
+/* Main Loop */
+
+/// Handle one SDL event
 ///
-/// @param vertexShaderSource Vertex shader source code
-/// @param fragmentShaderSource Fragment shader source code
-/// @return id of the program object
-GLuint CreateShaderProgram(std::string const &vertexShaderSource,
-                           std::string const &fragmentShaderSource)
+/// @return void
+void HandleEvent(SDL_Event const &e)
 {
-    // Create a new program object
-    GLuint programObject = glCreateProgram();
-
-    // Compile shaders
-    GLuint vertexShader = CompileShader(GL_VERTEX_SHADER /*enum*/, vertexShaderSource);
-    GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-
-    std::array<GLuint, 2> shaderList = {
-        vertexShader,
-        fragmentShader,
-    };
-
-    //- Link shader programs (.cpp + .cpp -> executable)
-
-    // Associate (attach) the shaders to the program object
-    std::for_each(shaderList.begin(), shaderList.end(),
-                  [&](GLuint shader) { glAttachShader(programObject, shader); });
-
-    // Link a program object
-    glLinkProgram(programObject);
-
-#ifdef DEBUG
-    // Check the status of the link
-    GLint linkStatus = GL_FALSE;
-    glGetProgramiv(programObject, GL_LINK_STATUS, &linkStatus);
-    if (linkStatus == GL_FALSE)
+    // If user posts an event to quit (red x button on the corner of the window)
+    if (e.type == SDL_QUIT)
     {
-        std::array<char, MAX_GL_INFO_LOG_LEN> infoLog = {0};
-        glGetProgramInfoLog(programObject, static_cast<GLsizei>(infoLog.size()), nullptr,
-                            infoLog.data());
-        std::cerr << "ERROR::PROGRAM::LINKING_FAILED\n" << infoLog.data() << std::endl;
+        std::cout << "Goodbye!" << std::endl;
+        App::quit = true;
     }
 
-#endif
-
-    //- Validation
-
-    // OpenGL requires a VAO to be bound when you validate or use a shader program that interacts
-    // with vertex attributes.
-    //
-    // [extra] Bind the VAO before validating the program
-    // [why?] b/c otherwise we get the following error:  No vertex array object bound
-    glBindVertexArray(App::vertexArrayObject);
-
-    // Validate the program
-    glValidateProgram(programObject);
-
-#ifdef DEBUG
-    GLint validateStatus = GL_FALSE;
-    glGetProgramiv(programObject, GL_VALIDATE_STATUS, &validateStatus);
-    if (validateStatus == GL_FALSE)
+    // F1 prints the frame timing statistics gathered so far
+    if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F1)
     {
-        std::array<char, MAX_GL_INFO_LOG_LEN> infoLog = {0};
-        glGetProgramInfoLog(programObject, static_cast<GLsizei>(infoLog.size()), nullptr,
-                            infoLog.data());
-        std::cerr << "ERROR::PROGRAM::VALIDATION_FAILED\n" << infoLog.data() << std::endl;
+        App::FrameStats::Dump(std::cout);
+        App::GpuTimer::Dump(std::cout);
+        App::StateCache::Dump(std::cout);
     }
-#endif
-
-    // [extra] Unbind the VAO after validation
-    // [why?] b/c otherwise we get the following error:  No vertex array object bound
-    glBindVertexArray(0);
 
-    // Once our final program object has been created, we can detach and delete the individual
-    // shaders
-    std::for_each(shaderList.begin(), shaderList.end(),
-                  [&](GLuint shader) { glDetachShader(programObject, shader); });
-    std::for_each(shaderList.begin(), shaderList.end(), glDeleteShader);
-
-    return programObject;
+    // Anything but our own wake up event may change what is on screen (input, window exposed or
+    // resized, ...)
+    if (e.type != App::wakeUpEventType)
+    {
+        App::sceneDirty.store(true, std::memory_order_relaxed);
+    }
 }
 
-/* Main Loop */
-
 /// Handle user inputs (via SDL)
 ///
 /// @return void
@@ -262,37 +335,162 @@ void Input()
     // Handle events on queue
     while (SDL_PollEvent(&e) != 0)
     {
-        // If user posts an event to quit (red x button on the corner of the window)
-        if (e.type == SDL_QUIT)
+        HandleEvent(e);
+    }
+}
+
+/// Block until the next frame has to be rendered (`LoopMode::OnDemand`): sleeps in
+/// SDL_WaitEventTimeout, handling the events as they arrive, until the frame is marked dirty.
+///
+/// @return void
+void WaitUntilDirty()
+{
+    // Only a safety net: `MarkDirty` wakes us up with an event
+    constexpr int idleTimeoutMs = 500;
+
+    SDL_Event e;
+    while (!App::sceneDirty.load(std::memory_order_relaxed) && !App::quit)
+    {
+        if (SDL_WaitEventTimeout(&e, idleTimeoutMs) != 0)
         {
-            std::cout << "Goodbye!" << std::endl;
-            App::quit = true;
+            HandleEvent(e);
         }
     }
 }
 
+/// Advance the simulation by one fixed time step
+///
+/// @param state the state to advance
+/// @param dt duration of the step in seconds
+/// @return void
+void Step(SimulationState &state, double dt)
+{
+    state.time += dt;
+
+    if (App::animate)
+    {
+        // Pulse the background once every two seconds
+        constexpr double pulseFrequency = 0.5;
+        double const phase = 2.0 * std::numbers::pi * pulseFrequency * state.time;
+        state.brightness = static_cast<GLfloat>(0.75 + (0.25 * std::cos(phase)));
+        state.sway = static_cast<GLfloat>(0.1 * std::sin(phase));
+    }
+}
+
+/// Run as many fixed simulation steps as fit in the elapsed real time, and interpolate the state to
+/// render between the last two of them
+///
+/// @param frameTime real time elapsed since the previous frame in seconds
+/// @return void
+void Update(double frameTime)
+{
+    simulationAccumulator += std::min(frameTime, maxFrameTime);
+
+    while (simulationAccumulator >= simulationStep)
+    {
+        previousState = currentState;
+        Step(currentState, simulationStep);
+        simulationAccumulator -= simulationStep;
+    }
+
+    // How far we are between the last two steps
+    auto const alpha = static_cast<GLfloat>(simulationAccumulator / simulationStep);
+    renderState.time = previousState.time + ((currentState.time - previousState.time) * alpha);
+    renderState.brightness = previousState.brightness +
+                             ((currentState.brightness - previousState.brightness) * alpha);
+    renderState.sway = previousState.sway + ((currentState.sway - previousState.sway) * alpha);
+
+    // An animated scene is never static
+    if (App::animate)
+    {
+        App::MarkDirty();
+    }
+}
+
 /// Setting some sort of OpenGL state prior to darwing
 /// Note: some of the calls may take place at different stages (post-processing) of the pipeline
 ///
 /// @return void
 void PreDraw()
 {
-    // Disable depth test and face culling
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    // Bind the program (or, with separable shaders, the program pipeline) and the vertex layout and
+    // set the fixed-function state and the view port in one go. It does not change from one frame
+    // to the next, so after the first frame this does nothing.
+    App::PipelineState::Apply(graphicsPipelineState);
 
-    // Specify the view port
-    glViewport(0, 0, App::screenWidth, App::screenHeight);
-
-    // Set the clear color (background color of the screen)
-    glClearColor(App::bg.r, App::bg.g, App::bg.b, App::bg.a);
+    // Set the clear color (background color of the screen); it only changes while animating
+    GLfloat const brightness = renderState.brightness;
+    App::StateCache::ClearColor(App::bg.r * brightness, App::bg.g * brightness,
+                                App::bg.b * brightness, App::bg.a);
 
     // Clear color buffer and depth buffer with the specified color above
-    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT); // NOLINT
+    App::GpuTimer::Begin(App::GpuTimer::Pass::PreDraw);
+    GLCall(glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT)); // NOLINT
+    App::GpuTimer::End(App::GpuTimer::Pass::PreDraw);
+
+    // With separable shaders, the vertex stage has its own program
+    GLuint const vertexProgram = App::ProgramPermutations::separable
+                                     ? graphicsProgramPipeline.vertexProgram
+                                     : App::graphicsPipelineShaderProgram;
+
+    // Unchanged uniforms are not uploaded again (only changes while animating)
+    constexpr std::uint64_t offsetUniform = App::ProgramReflection::Id("u_offset");
+    App::ProgramReflection::SetUniform(vertexProgram, offsetUniform,
+                                       std::array<GLfloat, 2>{renderState.sway, 0.0F});
+
+    // Only changes with the mesh (or after a shader reload)
+    constexpr std::uint64_t positionScaleUniform = App::ProgramReflection::Id("u_positionScale");
+    constexpr std::uint64_t positionOffsetUniform = App::ProgramReflection::Id("u_positionOffset");
+    App::ProgramReflection::SetUniform(vertexProgram, positionScaleUniform,
+                                       meshPositionTransform.scale);
+    App::ProgramReflection::SetUniform(vertexProgram, positionOffsetUniform,
+                                       meshPositionTransform.offset);
+}
+
+/// Point the position (0) and color (1) attributes of the bound vertex array at the vertices in
+/// the buffer bound to GL_ARRAY_BUFFER. The quantized formats are converted back by the vertex
+/// fetch (normalized integers), except for the position transform.
+///
+/// @param format the vertex format of the vertices
+/// @param offset where the vertices start in the buffer
+/// @return void
+void SpecifyAttributes(App::Mesh::VertexFormat format, GLintptr offset)
+{
+    auto const stride = static_cast<GLsizei>(App::Mesh::VertexSize(format));
+    std::array<App::Mesh::AttributeFormat, 2> const attributes = App::Mesh::Attributes(format);
+    for (GLuint location = 0; location < attributes.size(); ++location)
+    {
+        App::Mesh::AttributeFormat const &attribute = attributes[location];
+        auto const start = static_cast<std::uintptr_t>(offset) + attribute.offset;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, attribute.size, attribute.type, attribute.normalized,
+                              stride, reinterpret_cast<GLvoid *>(start)); // NOLINT
+    }
+}
+
+/// Upload the vertices of the mesh again, as dynamic geometry would be, into the next space of the
+/// ring, and point the attributes at it
+///
+/// @return bool whether the vertices could be uploaded (the attributes are left as they are
+/// otherwise)
+bool StreamVertices()
+{
+    TRACE_SCOPE("StreamVertices");
+
+    auto const stride = static_cast<GLsizeiptr>(App::Mesh::VertexSize(streamedFormat));
+    App::StreamBuffer::Allocation const allocation = App::StreamBuffer::Map(
+        vertexStream, static_cast<GLsizeiptr>(streamedVertices.size()), stride);
+    if (allocation.pointer == nullptr)
+    {
+        std::cerr << "Could not map the vertex stream buffer: skipping the frame's draw calls"
+                  << std::endl;
+        return false;
+    }
+    std::memcpy(allocation.pointer, streamedVertices.data(), streamedVertices.size());
+    App::StreamBuffer::Unmap(vertexStream);
 
-    // Use the compiled (and linked) program that have two shaders in it
-    // This sets the current shader program to be used by all the subsequent rendering commands.
-    glUseProgram(App::graphicsPipelineShaderProgram);
+    SpecifyAttributes(streamedFormat, allocation.offset);
+    return true;
 }
 
 /// The render function that gets called once per loop
@@ -302,15 +500,115 @@ void PreDraw()
 /// @return void
 void Draw()
 {
-    // Enable attributes (position in this case)
-    glBindVertexArray(App::vertexArrayObject);
+    // The vertex array (with the attributes enabled) is bound by the pipeline state (see PreDraw).
+    // Without this frame's vertices, the attributes may point at storage that was orphaned.
+    if (App::streamVertices && !StreamVertices())
+    {
+        return;
+    }
+
+    // Draw vertices specified in the index buffer (once per object), in a single instanced draw
+    // call with the instancing permutation
+    App::GpuTimer::Begin(App::GpuTimer::Pass::Draw);
+    if ((App::shaderFeatures & App::ProgramPermutations::Instancing) != 0)
+    {
+        GLCall(glDrawElementsInstanced(GL_TRIANGLES, App::indexCount, App::indexType, nullptr,
+                                       static_cast<GLsizei>(App::objectCount)));
+        App::drawCallCount += 1;
+    }
+    else
+    {
+        for (unsigned long i = 0; i < App::objectCount; ++i)
+        {
+            GLCall(glDrawElements(GL_TRIANGLES, App::indexCount, App::indexType, nullptr)); // NOLINT
+        }
+        App::drawCallCount += App::objectCount;
+    }
+    App::GpuTimer::End(App::GpuTimer::Pass::Draw);
+
+    // The GPU is done with this frame's vertices once it is done with these draw calls
+    if (App::streamVertices)
+    {
+        App::StreamBuffer::EndFrame(vertexStream);
+    }
+
+    // Note: we do not stop using our current graphics pipeline (glUseProgram(0)) here. It is not
+    // necessary, and with the state left bound the next frame's PipelineState::Apply is elided.
+}
+
+/// Load a mesh file and specify it as the geometry, scaled and centered to fit in the view like the
+/// built-in quad (the vertex shader uses the positions as clip space positions). The mesh is baked
+/// into the MeshCache the first time, and mapped from there afterwards.
+/// Exits the program if the mesh cannot be loaded.
+///
+/// @param path OBJ or glTF binary file
+/// @return void
+void LoadMesh(char const *path)
+{
+    auto const start = std::chrono::steady_clock::now();
+    auto const report = [&](std::size_t vertexCount, std::size_t indexCount, char const *how) {
+        std::chrono::duration<double, std::milli> const time =
+            std::chrono::steady_clock::now() - start;
+        std::cout << "Mesh " << path << ": " << vertexCount << " vertices, " << indexCount / 3
+                  << " triangles, " << how << " and uploaded in " << time.count() << " ms"
+                  << std::endl;
+    };
 
-    // Draw vertices specified in the index buffer
-    GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);); // Checking OpenGL errors
+    App::MeshCache::Mapping mapping;
+    if (App::MeshCache::Open(path, App::meshVertexFormat, mapping))
+    {
+        App::VertexSpecification(mapping.format, mapping.vertices, mapping.transform,
+                                 mapping.indexType, mapping.indices);
+        report(mapping.vertices.size() / App::Mesh::VertexSize(mapping.format),
+               mapping.indices.size() / App::Mesh::IndexSize(mapping.indexType),
+               "mapped from the cache");
+        App::MeshCache::Close(mapping);
+        return;
+    }
+
+    App::Mesh::Mesh mesh;
+    if (!App::Mesh::Load(path, mesh))
+    {
+        exit(7); // NOLINT
+    }
 
-    // Stop using our current graphics pipeline
-    // Note: this is not necessary if we only have on graphics pipe line.
-    glUseProgram(0);
+    GLfloat extent = 0.0F;
+    std::array<GLfloat, 3> center{};
+    for (std::size_t c = 0; c < 3; ++c)
+    {
+        extent = std::max(extent, mesh.boundsMax[c] - mesh.boundsMin[c]);
+        center[c] = (mesh.boundsMin[c] + mesh.boundsMax[c]) / 2.0F;
+    }
+    GLfloat const scale = extent > 0.0F ? 1.0F / extent : 1.0F;
+    for (App::Mesh::Vertex &vertex : mesh.vertices)
+    {
+        for (std::size_t c = 0; c < 3; ++c)
+        {
+            vertex.position[c] = (vertex.position[c] - center[c]) * scale;
+        }
+    }
+    App::Mesh::ComputeBounds(mesh);
+
+    // Reorder the triangles and the vertices (baked into the cache, so only done once)
+    App::MeshOptimizer::Statistics const before =
+        App::MeshOptimizer::Analyze(mesh.indices, mesh.vertices.size());
+    App::MeshOptimizer::Optimize(mesh);
+    App::MeshOptimizer::Statistics const after =
+        App::MeshOptimizer::Analyze(mesh.indices, mesh.vertices.size());
+
+    App::Mesh::PackedVertices const vertices = App::Mesh::Pack(mesh, App::meshVertexFormat);
+    App::Mesh::PackedIndices const indices = App::Mesh::PackIndices(mesh);
+    App::VertexSpecification(vertices.format, vertices.data, vertices.transform, indices.type,
+                             indices.data);
+    report(mesh.vertices.size(), mesh.indices.size(), "parsed, optimized");
+    std::cout << "Mesh " << path << ": ACMR " << before.acmr << " -> " << after.acmr << ", ATVR "
+              << before.atvr << " -> " << after.atvr << " (" << App::MeshOptimizer::cacheSize
+              << " entry FIFO), "
+              << (indices.type == GL_UNSIGNED_SHORT ? "16-bit" : "32-bit") << " indices"
+              << std::endl;
+
+    // Bake what was uploaded, for the next run
+    App::MeshCache::Store(path, vertices, indices);
 }
 
 } // namespace
@@ -321,8 +619,22 @@ void Draw()
 /// @return void
 void App::Initialize()
 {
+    TRACE_SCOPE("Initialize");
+
+    // In headless mode ask SDL for its offscreen video driver (EGL based), which does not need a
+    // display server. An explicit SDL_VIDEODRIVER environment variable still takes precedence.
+    if (App::headless && SDL_getenv("SDL_VIDEODRIVER") == nullptr)
+    {
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+    }
+
     // Initialize SDL
-    if (SDL_Init(SDL_INIT_VIDEO) < 0)
+    int initResult = 0;
+    {
+        TRACE_SCOPE("SDL_Init");
+        initResult = SDL_Init(SDL_INIT_VIDEO);
+    }
+    if (initResult < 0)
     {
         std::cerr << "SDL2 could not initialize video subsystem: " << SDL_GetError() << std::endl;
         exit(1); // NOLINT
@@ -341,9 +653,12 @@ void App::Initialize()
     SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
 
     // Create an application window using OpenGL that supports SDL
+    // In headless mode the window is never shown; it only exists to own the OpenGL context.
+    Uint32 const windowFlags = SDL_WINDOW_OPENGL | (App::headless ? SDL_WINDOW_HIDDEN
+                                                                  : SDL_WINDOW_SHOWN);
     App::graphicsApplicationWindow = SDL_CreateWindow(
         "OpenGL Window", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, // NOLINT
-        App::screenWidth, App::screenHeight, SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN);
+        App::screenWidth, App::screenHeight, windowFlags);
 
     if (App::graphicsApplicationWindow == nullptr)
     {
@@ -352,7 +667,10 @@ void App::Initialize()
     }
 
     // Create an OpenGL graphics context (a big struct)
-    App::openGLContext = SDL_GL_CreateContext(App::graphicsApplicationWindow);
+    {
+        TRACE_SCOPE("SDL_GL_CreateContext");
+        App::openGLContext = SDL_GL_CreateContext(App::graphicsApplicationWindow);
+    }
 
     if (App::openGLContext == nullptr)
     {
@@ -361,7 +679,12 @@ void App::Initialize()
     }
 
     // Initialize GLAD library
-    if (gladLoadGLLoader(static_cast<GLADloadproc>(SDL_GL_GetProcAddress)) == 0)
+    int gladResult = 0;
+    {
+        TRACE_SCOPE("gladLoadGLLoader");
+        gladResult = gladLoadGLLoader(static_cast<GLADloadproc>(SDL_GL_GetProcAddress));
+    }
+    if (gladResult == 0)
     {
         std::cerr << "Could not initialize Glad." << std::endl;
         exit(4); // NOLINT
@@ -369,6 +692,52 @@ void App::Initialize()
 
     // Once Glad is setup we can access OpenGL API
     GetOpenGLVersionInfo();
+
+    // Capture everything from here on (including the offscreen framebuffer setup)
+    if (App::glCapturePath != nullptr)
+    {
+        App::GLRecorder::Start(App::glCapturePath, App::screenWidth, App::screenHeight);
+    }
+
+    if (App::headless)
+    {
+        // Nothing is presented, so there is no reason to wait for vertical sync
+        SDL_GL_SetSwapInterval(0);
+
+        CreateOffscreenFramebuffer();
+    }
+    else if (SDL_GL_SetSwapInterval(static_cast<int>(App::swapInterval)) < 0)
+    {
+        std::cerr << "Could not set the swap interval: " << SDL_GetError() << std::endl;
+        if (App::swapInterval == SwapInterval::Adaptive)
+        {
+            std::cerr << "Falling back to vsync" << std::endl;
+            SDL_GL_SetSwapInterval(static_cast<int>(SwapInterval::On));
+        }
+    }
+
+    // GPU timer queries (GL_TIME_ELAPSED is core since OpenGL 3.3)
+    App::GpuTimer::Initialize();
+
+    // Let the driver compile shaders on its own threads if it can
+    App::Shader::Initialize();
+    std::cout << "Parallel shader compilation: "
+              << (App::Shader::ParallelCompileSupported() ? "yes" : "no") << std::endl;
+
+    // Event used by `MarkDirty` to wake up the main loop
+    App::wakeUpEventType = SDL_RegisterEvents(1);
+}
+
+void App::MarkDirty()
+{
+    // Only the first request since the last frame needs to wake up the main loop
+    bool const wasDirty = App::sceneDirty.exchange(true, std::memory_order_relaxed);
+    if (!wasDirty && App::loopMode == LoopMode::OnDemand && App::wakeUpEventType != ~0U)
+    {
+        SDL_Event e{};
+        e.type = App::wakeUpEventType;
+        SDL_PushEvent(&e);
+    }
 }
 
 /// Setup geometry/model/mesh during vertex specification step
@@ -380,6 +749,12 @@ void App::Initialize()
 /// @return void
 void App::VertexSpecification()
 {
+    if (App::meshPath != nullptr)
+    {
+        LoadMesh(App::meshPath);
+        return;
+    }
+
     // Model/Geometry/Mesh data
     // Specify the x,y,z position and r,g,b color attributes within vertexPositions for the data.
     // This information is stored in the CPU, and we need to store the data on the GPU in a call to
@@ -403,6 +778,71 @@ void App::VertexSpecification()
         +0.0F, +0.0F, +1.0F, // vertex 3 - color
     };
 
+    // Index/Element Buffer Object (IBO i.e. EBO) data
+    std::vector<GLuint> const indexBufferData{
+        2, 0, 1, // First triangle
+        3, 2, 1, // Second triangle
+    };
+
+    App::VertexSpecification(vertexData, indexBufferData);
+}
+
+/// Upload a mesh to the GPU and describe its layout (replacing the previously specified one).
+///
+/// @param vertexData interleaved vertices: x, y, z position followed by r, g, b color
+/// @param indexBufferData indices of the triangles (three per triangle)
+/// @return void
+void App::VertexSpecification(std::vector<GLfloat> const &vertexData,
+                              std::vector<GLuint> const &indexBufferData)
+{
+    App::Mesh::Mesh mesh;
+    mesh.vertices.reserve(vertexData.size() / 6);
+    for (std::size_t i = 0; i + 6 <= vertexData.size(); i += 6)
+    {
+        mesh.vertices.push_back({{vertexData[i], vertexData[i + 1], vertexData[i + 2]},
+                                 {vertexData[i + 3], vertexData[i + 4], vertexData[i + 5]},
+                                 {}});
+    }
+    mesh.indices = indexBufferData;
+
+    App::VertexSpecification(mesh);
+}
+
+/// Upload a mesh to the GPU and describe its layout (replacing the previously specified one).
+///
+/// @param mesh interleaved vertices and triangle indices
+/// @param format the vertex format the vertices are packed in (see Mesh::Pack)
+/// @return void
+void App::VertexSpecification(Mesh::Mesh const &mesh, Mesh::VertexFormat format)
+{
+    Mesh::PackedVertices const vertices = Mesh::Pack(mesh, format);
+    Mesh::PackedIndices const indices = Mesh::PackIndices(mesh);
+    App::VertexSpecification(vertices.format, vertices.data, vertices.transform, indices.type,
+                             indices.data);
+}
+
+/// Upload a mesh to the GPU and describe its layout (replacing the previously specified one).
+/// The data is copied by the driver straight from where it is (e.g. a mapped MeshCache file).
+///
+/// @param format the vertex format of `vertices`
+/// @param vertices packed vertices (uploaded as they are)
+/// @param transform dequantization of the positions, applied by the vertex shader
+/// @param indexType GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+/// @param indices indices of the triangles (three per triangle)
+/// @return void
+void App::VertexSpecification(Mesh::VertexFormat format, std::span<std::byte const> vertices,
+                              Mesh::PositionTransform const &transform, GLenum indexType,
+                              std::span<std::byte const> indices)
+{
+    TRACE_SCOPE("VertexSpecification");
+
+    // Release the previous mesh, if any (deleting the bound VAO would reset the binding behind the
+    // state cache's back)
+    App::StateCache::BindVertexArray(0);
+    glDeleteBuffers(1, &App::indexBufferObject);
+    glDeleteBuffers(1, &App::vertexBufferObject);
+    glDeleteVertexArrays(1, &App::vertexArrayObject);
+
     //- Set things up on the GPU
 
     // The following command set up the coordinates of the triangle to be rendered.
@@ -416,7 +856,7 @@ void App::VertexSpecification()
     // operations Generate 1 vertex array object.
     glGenVertexArrays(1, &App::vertexArrayObject);
     // Bind to the desired VAO -> GL_ARRAY_BUFFER
-    glBindVertexArray(App::vertexArrayObject);
+    App::StateCache::BindVertexArray(App::vertexArrayObject);
 
     // Vertex Buffer Object (VBO) setup
     // Generate 1 new VBO and bind to it to store vertex positions and colors
@@ -429,42 +869,53 @@ void App::VertexSpecification()
     // 2. Copying data from our memory array into the buffer object
     // After this function call, the buffer object stores exactly what vertexPositions stores.
     //
-    glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(GLfloat), // NOLINT
-                 vertexData.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size_bytes()), vertices.data(),
+                 GL_STATIC_DRAW);
 
     // Index/Element Buffer Object (IBO i.e. EBO)
-    std::vector<GLuint> const indexBufferData{
-        2, 0, 1, // First triangle
-        3, 2, 1, // Second triangle
-    };
     glGenBuffers(1, &App::indexBufferObject);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, App::indexBufferObject);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                 static_cast<GLsizeiptr>(indexBufferData.size() * sizeof(GLuint)),
-                 indexBufferData.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size_bytes()),
+                 indices.data(), GL_STATIC_DRAW);
+    App::indexCount = static_cast<GLsizei>(indices.size() / Mesh::IndexSize(indexType));
+    App::indexType = indexType;
 
     //- So far we managed to put the vertex data in GPU's memory. However VBO is not formatted.
     // Now we need to tell OpenGL what form the vertex data in VBO takes.
 
-    // Specify position
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), nullptr);
+    // Specify position and color
+    SpecifyAttributes(format, 0);
+    meshPositionTransform = transform;
 
-    // Specify Color
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat),
-                          reinterpret_cast<GLvoid *>(3 * sizeof(GLfloat))); // NOLINT
+    // Dynamic geometry: the static vertex buffer is only the layout, the vertices drawn come from
+    // the ring (see Draw)
+    if (App::streamVertices)
+    {
+        streamedVertices.assign(vertices.begin(), vertices.end());
+        streamedFormat = format;
+        App::StreamBuffer::Create(vertexStream, GL_ARRAY_BUFFER,
+                                  static_cast<GLsizeiptr>(vertices.size_bytes() * 3),
+                                  App::streamMode);
+    }
 
     //- Now that OpenGL knows where to find the data and how to interpret it
 
     //- Clean Up
 
     // Unbind currently bound VAO
-    glBindVertexArray(0);
+    App::StateCache::BindVertexArray(0);
 
     // Disable any attribute we opened in our VAO as we do not want to leave them open.
     glDisableVertexAttribArray(0);
     glDisableVertexAttribArray(1);
+
+    // The pipeline state names the vertex array, and the one it made current is unbound now:
+    // describe the new one (once there is a pipeline, see CreateGraphicsPipeline)
+    App::PipelineState::Invalidate();
+    if (graphicsPipelineState != App::PipelineState::invalidId)
+    {
+        CreatePipelineState();
+    }
 }
 
 /// Once the geometry is ready, create the graphics pipeline (setting up vertex and fragment
@@ -473,11 +924,43 @@ void App::VertexSpecification()
 /// @return void
 void App::CreateGraphicsPipeline()
 {
-    std::string vertexShaderSource = LoadShaderAsString("./shaders/vert.glsl");
-    std::string fragmentShaderSource = LoadShaderAsString("./shaders/frag.glsl");
+    TRACE_SCOPE("CreateGraphicsPipeline");
+
+    // Hot reload edits the shaders on disk, not the copies embedded into the binary
+    if (App::hotReload && App::ShaderSource::directory.empty())
+    {
+        App::ShaderSource::directory = "./shaders";
+    }
+
+    // Build the permutations used by the previous run up front, in one batch
+    if (App::permutationListPath != nullptr)
+    {
+        App::ProgramPermutations::Prewarm(App::permutationListPath);
+    }
+
+    if (App::ProgramPermutations::separable)
+    {
+        graphicsProgramPipeline = App::ProgramPermutations::GetPipeline(App::shaderFeatures);
+    }
+    else
+    {
+        App::graphicsPipelineShaderProgram = App::ProgramPermutations::Get(App::shaderFeatures);
+    }
+
+    if (App::graphicsPipelineShaderProgram == 0 && graphicsProgramPipeline.pipeline == 0)
+    {
+        std::cerr << "Could not create the graphics pipeline." << std::endl;
+        exit(6); // NOLINT
+    }
 
-    App::graphicsPipelineShaderProgram = CreateShaderProgram(vertexShaderSource,
-                                                             fragmentShaderSource);
+    CreatePipelineState();
+
+    if (App::hotReload && !App::ShaderWatcher::Start(App::ShaderSource::directory,
+                                                     LoadPipelineSources))
+    {
+        std::cerr << "Could not watch " << App::ShaderSource::directory
+                  << ", hot reload is disabled" << std::endl;
+    }
 }
 
 /// Main application (infinite) loop
@@ -485,16 +968,72 @@ void App::CreateGraphicsPipeline()
 /// @return void
 void App::MainLoop()
 {
-    while (!quit)
+    using App::FrameStats::Phase;
+    using App::FrameStats::ScopedTimer;
+    using Clock = App::FrameStats::Clock;
+
+    App::FramePacer::SetTargetFrameRate(App::targetFrameRate);
+    Clock::time_point previousFrameStart = Clock::now();
+
+    while (!quit && (App::frameLimit == 0 || App::frameCount < App::frameLimit))
     {
+        // Sleep while there is nothing new to show, then until the frame limiter lets the next
+        // frame start (neither is part of the frame time)
+        if (App::loopMode == App::LoopMode::OnDemand)
+        {
+            TRACE_SCOPE("Idle");
+            WaitUntilDirty();
+        }
+        {
+            TRACE_SCOPE("FramePacer");
+            App::FramePacer::WaitForNextFrame();
+        }
+
+        Clock::time_point const frameStart = Clock::now();
+        auto const interval = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            frameStart - previousFrameStart);
+        App::FrameStats::Record(Phase::Interval, static_cast<std::uint64_t>(interval.count()));
+        previousFrameStart = frameStart;
+
+        // Every phase of the frame is timed; see FrameStats for the collected statistics
+        TRACE_SCOPE("Frame");
+        ScopedTimer const frameTimer{Phase::Frame};
+        App::GLRecorder::Frame();
+
+        // This frame shows everything requested so far; anything requested from now on (including
+        // by another thread while the frame is prepared) requires another frame
+        App::sceneDirty.exchange(false, std::memory_order_relaxed);
+
+        // Edited shaders take effect at the start of a frame
+        ReloadGraphicsPipeline();
+
         // Handle inputs
-        Input();
+        {
+            TRACE_SCOPE("Input");
+            ScopedTimer const timer{Phase::Input};
+            Input();
+        }
+
+        // Advance the simulation by the real time elapsed since the previous frame
+        {
+            TRACE_SCOPE("Update");
+            ScopedTimer const timer{Phase::Update};
+            Update(std::chrono::duration<double>(interval).count());
+        }
 
         // Setup anything prior to rendering (e.g. setting up OpenGL state)
-        PreDraw();
+        {
+            TRACE_SCOPE("PreDraw");
+            ScopedTimer const timer{Phase::PreDraw};
+            PreDraw();
+        }
 
         // Draw (rendering) calls in OpenGL
-        Draw();
+        {
+            TRACE_SCOPE("Draw");
+            ScopedTimer const timer{Phase::Draw};
+            Draw();
+        }
 
         // Update the screen on the specified window.
         // The OpenGL framebuffer is double-buffered: SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
@@ -502,12 +1041,78 @@ void App::MainLoop()
         // rendering to. Thus, all of our rendering is hidden from view until it is shown to the
         // user. This way, the user never sees a half-rendered image. This is the function that
         // causes the image we are rendering to be displayed to the user.
-        SDL_GL_SwapWindow(App::graphicsApplicationWindow);
+        // In headless mode there is nothing to present; we only make sure the commands of this
+        // frame are submitted to the driver.
+        {
+            TRACE_SCOPE("Swap");
+            ScopedTimer const timer{Phase::Swap};
+            if (App::headless)
+            {
+                glFlush();
+            }
+            else
+            {
+                SDL_GL_SwapWindow(App::graphicsApplicationWindow);
+            }
+        }
+
+        // One error check for the whole frame (depending on the GLCall policy, see GLCheck.h)
+        App::GLCheck::CheckFrame();
+
+        // Pick up the GPU timings of earlier frames that are ready by now
+        {
+            TRACE_SCOPE("GpuTimer::EndFrame");
+            App::GpuTimer::EndFrame();
+        }
+
+        ++App::frameCount;
     }
 }
 
 void App::CleanUp()
 {
+    App::ShaderWatcher::Stop();
+
+    // The clean up itself is not part of the capture
+    App::GLRecorder::Stop();
+
+    // Report where the frame time went
+    App::FrameStats::Dump(std::cout);
+    App::GpuTimer::Dump(std::cout);
+    App::StateCache::Dump(std::cout);
+    App::PipelineState::Dump(std::cout);
+    App::MeshCache::Dump(std::cout);
+    App::ProgramCache::Dump(std::cout);
+    App::ProgramPermutations::Dump(std::cout);
+    App::ProgramReflection::Dump(std::cout);
+    App::ShaderSource::Dump(std::cout);
+    if (App::streamVertices)
+    {
+        App::StreamBuffer::Dump(std::cout);
+    }
+
+    if (App::permutationListPath != nullptr)
+    {
+        App::ProgramPermutations::SaveUsed(App::permutationListPath);
+    }
+
+    App::GpuTimer::CleanUp();
+    App::StreamBuffer::Destroy(vertexStream);
+
+    // Write the timeline of all the traced zones (only with `make TRACE=1`)
+    TRACE_WRITE("trace.json");
+
+    if (App::offscreenFramebuffer != 0)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &App::offscreenFramebuffer);
+        glDeleteRenderbuffers(1, &App::offscreenColorBuffer);
+        glDeleteRenderbuffers(1, &App::offscreenDepthBuffer);
+    }
+
+    // Clean up OpenGL context
+    SDL_GL_DeleteContext(App::openGLContext);
+
     // Clean up SDL window
     SDL_DestroyWindow(App::graphicsApplicationWindow);
 
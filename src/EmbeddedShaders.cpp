@@ -0,0 +1,37 @@
+#include <array>
+
+#include "App/EmbeddedShaders.h"
+
+namespace {
+
+using App::EmbeddedShaders::File;
+
+// EmbeddedShaders.inc is generated by the Makefile from shaders/*.glsl: one
+// `EMBED_SHADER("name", R"glsl(contents)glsl")` line per file
+#define EMBED_SHADER(name, source) File{name, source},
+
+constexpr std::array embeddedFiles = {
+#include "EmbeddedShaders.inc"
+};
+
+#undef EMBED_SHADER
+
+} // namespace
+
+App::EmbeddedShaders::File const *App::EmbeddedShaders::Find(std::string_view name)
+{
+    for (File const &file : embeddedFiles)
+    {
+        if (file.name == name)
+        {
+            return &file;
+        }
+    }
+
+    return nullptr;
+}
+
+std::span<App::EmbeddedShaders::File const> App::EmbeddedShaders::All()
+{
+    return embeddedFiles;
+}
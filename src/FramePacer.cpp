@@ -0,0 +1,53 @@
+#include <chrono>
+#include <thread>
+
+#include "App/FramePacer.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+Clock::duration period{0};      // NOLINT
+Clock::time_point nextDeadline; // NOLINT
+
+} // namespace
+
+void App::FramePacer::SetTargetFrameRate(double framesPerSecond)
+{
+    period = framesPerSecond > 0.0
+                 ? std::chrono::duration_cast<Clock::duration>(
+                       std::chrono::duration<double>(1.0 / framesPerSecond))
+                 : Clock::duration{0};
+    nextDeadline = Clock::now();
+}
+
+void App::FramePacer::WaitForNextFrame()
+{
+    if (period == Clock::duration{0})
+    {
+        return;
+    }
+
+    nextDeadline += period;
+    Clock::time_point const now = Clock::now();
+
+    // Too late already: start over from now rather than running several frames back to back
+    if (now > nextDeadline + period)
+    {
+        nextDeadline = now;
+        return;
+    }
+
+    // Coarse sleep...
+    auto const spin = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(spinThreshold));
+    if (nextDeadline - now > spin)
+    {
+        std::this_thread::sleep_for(nextDeadline - now - spin);
+    }
+
+    // ...then spin to the deadline
+    while (Clock::now() < nextDeadline)
+    {
+    }
+}
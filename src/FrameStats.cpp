@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "App/FrameStats.h"
+
+namespace {
+
+constexpr std::size_t phaseCount = static_cast<std::size_t>(App::FrameStats::Phase::Count);
+
+std::array<App::FrameStats::RollingWindow, phaseCount> phaseWindows; // NOLINT
+
+/// Nearest-rank percentile of an already sorted list of samples, in milliseconds
+///
+/// @param sorted samples sorted in ascending order (must not be empty)
+/// @param percentile value in [0, 100]
+/// @return double the percentile in milliseconds
+double Percentile(std::vector<std::uint64_t> const &sorted, double percentile)
+{
+    // The smallest sample with at least `percentile` % of the samples at or below it
+    double const position = std::ceil(percentile / 100.0 * static_cast<double>(sorted.size()));
+    auto const rank = static_cast<std::size_t>(std::max(position, 1.0)) - 1;
+
+    return static_cast<double>(sorted[std::min(rank, sorted.size() - 1)]) / 1e6;
+}
+
+} // namespace
+
+void App::FrameStats::RollingWindow::Record(std::uint64_t nanoseconds)
+{
+    // Single writer: a relaxed read of our own counter is enough
+    std::uint64_t const n = count.load(std::memory_order_relaxed);
+    samples[n % windowSize].store(nanoseconds, std::memory_order_relaxed); // NOLINT
+
+    // Publish the sample to readers
+    count.store(n + 1, std::memory_order_release);
+}
+
+App::FrameStats::Summary App::FrameStats::RollingWindow::Summarize() const
+{
+    std::uint64_t const n = count.load(std::memory_order_acquire);
+    std::size_t const size = std::min<std::uint64_t>(n, windowSize);
+
+    Summary summary{};
+    summary.samples = size;
+    if (size == 0)
+    {
+        return summary;
+    }
+
+    std::vector<std::uint64_t> sorted(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        sorted[i] = samples[i].load(std::memory_order_relaxed); // NOLINT
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    summary.p50 = Percentile(sorted, 50.0);
+    summary.p95 = Percentile(sorted, 95.0);
+    summary.p99 = Percentile(sorted, 99.0);
+    summary.max = static_cast<double>(sorted.back()) / 1e6;
+
+    return summary;
+}
+
+void App::FrameStats::RollingWindow::Reset()
+{
+    count.store(0, std::memory_order_release);
+}
+
+void App::FrameStats::Record(Phase phase, std::uint64_t nanoseconds)
+{
+    phaseWindows[static_cast<std::size_t>(phase)].Record(nanoseconds); // NOLINT
+}
+
+App::FrameStats::Summary App::FrameStats::Query(Phase phase)
+{
+    return phaseWindows[static_cast<std::size_t>(phase)].Summarize(); // NOLINT
+}
+
+void App::FrameStats::Reset()
+{
+    std::for_each(phaseWindows.begin(), phaseWindows.end(),
+                  [](RollingWindow &window) { window.Reset(); });
+}
+
+void App::FrameStats::Dump(std::ostream &out)
+{
+    std::array<char, 128> line{};
+
+    std::snprintf(line.data(), line.size(), "%-12s %9s %9s %9s %9s %8s\n", "phase [ms]", "p50",
+                  "p95", "p99", "max", "samples");
+    out << line.data();
+
+    for (std::size_t i = 0; i < phaseCount; ++i)
+    {
+        auto const phase = static_cast<Phase>(i);
+        DumpRow(out, PhaseName(phase), Query(phase));
+    }
+}
+
+void App::FrameStats::DumpRow(std::ostream &out, char const *name, Summary const &summary)
+{
+    std::array<char, 128> line{};
+
+    std::snprintf(line.data(), line.size(), "%-12s %9.3f %9.3f %9.3f %9.3f %8zu\n", name,
+                  summary.p50, summary.p95, summary.p99, summary.max, summary.samples);
+    out << line.data();
+}
+
+char const *App::FrameStats::PhaseName(Phase phase)
+{
+    switch (phase)
+    {
+        case Phase::Input:
+            return "Input";
+        case Phase::Update:
+            return "Update";
+        case Phase::PreDraw:
+            return "PreDraw";
+        case Phase::Draw:
+            return "Draw";
+        case Phase::Swap:
+            return "Swap";
+        case Phase::Frame:
+            return "Frame";
+        case Phase::Interval:
+            return "Interval";
+        case Phase::Count:
+            break;
+    }
+
+    return "?";
+}
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+#include "App/GLCheck.h"
+
+namespace {
+
+struct CallSite
+{
+    char const *call = nullptr;
+    char const *file = nullptr;
+    int line = 0;
+};
+
+std::array<CallSite, App::GLCheck::callSiteRingSize> callSites{}; // NOLINT
+std::size_t callSiteCount = 0;                                     // NOLINT
+
+// Whether an error has been pinpointed during the current frame (in `checkEveryCall` mode)
+bool errorPinpointed = false; // NOLINT
+
+#if APP_GL_CHECK == 1
+/// Print the most recent call sites, oldest first
+///
+/// @return void
+void ReportRecentCallSites()
+{
+    std::size_t const n = std::min(callSiteCount, App::GLCheck::callSiteRingSize);
+
+    std::cerr << "\tLast " << n << " GLCall sites (oldest first):\n";
+    for (std::size_t i = callSiteCount - n; i < callSiteCount; ++i)
+    {
+        CallSite const &site = callSites[i % App::GLCheck::callSiteRingSize]; // NOLINT
+        std::cerr << "\t\t" << site.file << ':' << site.line << ": " << site.call << '\n';
+    }
+}
+#endif
+
+} // namespace
+
+namespace App::GLCheck {
+
+bool checkEveryCall = false; // NOLINT
+
+} // namespace App::GLCheck
+
+void App::GLCheck::RecordCallSite(char const *call, char const *file, int line)
+{
+    callSites[callSiteCount % callSiteRingSize] = CallSite{call, file, line}; // NOLINT
+    ++callSiteCount;
+}
+
+void App::GLCheck::ClearAllErrors()
+{
+    // GL_NO_ERROR: no error has been recorded
+    while (glGetError() != GL_NO_ERROR)
+    {
+    }
+}
+
+bool App::GLCheck::CheckErrorStatus(char const *call, char const *file, int line)
+{
+    bool failed = false;
+    while (GLenum const error = glGetError())
+    {
+        std::cerr << "OpenGL Error: " << ErrorName(error) << " (" << error << ")"
+                  << "\n\tLocation: " << file << ':' << line << "\n\tCall: " << call << "\n\n";
+        failed = true;
+    }
+
+    errorPinpointed = errorPinpointed || failed;
+    return failed;
+}
+
+bool App::GLCheck::CheckFrame()
+{
+#if APP_GL_CHECK == 1
+    GLenum const error = glGetError();
+
+    if (error == GL_NO_ERROR)
+    {
+        // A clean frame: back to the cheap mode
+        checkEveryCall = false;
+        errorPinpointed = false;
+        callSiteCount = 0;
+        return false;
+    }
+
+    std::cerr << "OpenGL Error during the last frame: " << ErrorName(error) << " (" << error
+              << ")\n";
+    ClearAllErrors();
+
+    if (checkEveryCall && !errorPinpointed)
+    {
+        std::cerr << "\tNot raised by any GLCall site (unwrapped OpenGL call)\n";
+    }
+    ReportRecentCallSites();
+
+    // Check each call of the next frame to find the offending one
+    if (!checkEveryCall)
+    {
+        std::cerr << "\tChecking every GLCall of the next frame...\n";
+    }
+    checkEveryCall = true;
+    errorPinpointed = false;
+    callSiteCount = 0;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+char const *App::GLCheck::ErrorName(GLenum error)
+{
+    switch (error)
+    {
+        case GL_NO_ERROR:
+            return "GL_NO_ERROR";
+        case GL_INVALID_ENUM:
+            return "GL_INVALID_ENUM";
+        case GL_INVALID_VALUE:
+            return "GL_INVALID_VALUE";
+        case GL_INVALID_OPERATION:
+            return "GL_INVALID_OPERATION";
+        case GL_INVALID_FRAMEBUFFER_OPERATION:
+            return "GL_INVALID_FRAMEBUFFER_OPERATION";
+        case GL_OUT_OF_MEMORY:
+            return "GL_OUT_OF_MEMORY";
+        default:
+            return "unknown error";
+    }
+}
@@ -0,0 +1,660 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+
+#include "App/GLCapture.h"
+#include "App/GLRecorder.h"
+
+namespace {
+
+using App::GLCapture::Op;
+
+// The OpenGL functions that are captured (everything the application calls for its setup and its
+// frames). Calls to other functions still work, they are just not part of the capture.
+#define RECORDED_FUNCTIONS(X)                                                                      \
+    X(GenVertexArrays)                                                                             \
+    X(DeleteVertexArrays)                                                                          \
+    X(BindVertexArray)                                                                             \
+    X(GenBuffers)                                                                                  \
+    X(DeleteBuffers)                                                                               \
+    X(BindBuffer)                                                                                  \
+    X(BufferData)                                                                                  \
+    X(BufferSubData)                                                                               \
+    X(MapBufferRange)                                                                              \
+    X(UnmapBuffer)                                                                                 \
+    X(EnableVertexAttribArray)                                                                     \
+    X(DisableVertexAttribArray)                                                                    \
+    X(VertexAttribPointer)                                                                         \
+    X(CreateShader)                                                                                \
+    X(ShaderSource)                                                                                \
+    X(CompileShader)                                                                               \
+    X(DeleteShader)                                                                                \
+    X(CreateProgram)                                                                               \
+    X(AttachShader)                                                                                \
+    X(DetachShader)                                                                                \
+    X(LinkProgram)                                                                                 \
+    X(ValidateProgram)                                                                             \
+    X(UseProgram)                                                                                  \
+    X(DeleteProgram)                                                                               \
+    X(Enable)                                                                                      \
+    X(Disable)                                                                                     \
+    X(Viewport)                                                                                    \
+    X(ClearColor)                                                                                  \
+    X(Clear)                                                                                       \
+    X(DrawArrays)                                                                                  \
+    X(DrawElements)                                                                                \
+    X(GenFramebuffers)                                                                             \
+    X(DeleteFramebuffers)                                                                          \
+    X(BindFramebuffer)                                                                             \
+    X(GenRenderbuffers)                                                                            \
+    X(DeleteRenderbuffers)                                                                         \
+    X(BindRenderbuffer)                                                                            \
+    X(RenderbufferStorage)                                                                         \
+    X(FramebufferRenderbuffer)                                                                     \
+    X(DrawElementsInstanced)                                                                       \
+    X(ProgramUniform1i)                                                                            \
+    X(ProgramUniform1f)                                                                            \
+    X(ProgramUniform2fv)                                                                           \
+    X(ProgramUniform3fv)                                                                           \
+    X(ProgramUniform4fv)                                                                           \
+    X(ProgramUniformMatrix4fv)                                                                     \
+    X(ProgramParameteri)                                                                           \
+    X(GenProgramPipelines)                                                                         \
+    X(DeleteProgramPipelines)                                                                      \
+    X(BindProgramPipeline)                                                                         \
+    X(UseProgramStages)                                                                            \
+    X(DepthFunc)                                                                                   \
+    X(DepthMask)                                                                                   \
+    X(CullFace)                                                                                    \
+    X(FrontFace)                                                                                   \
+    X(BlendFunc)
+
+/// The function pointers loaded by glad, called by the recording wrappers
+struct OriginalFunctions
+{
+#define DECLARE_ORIGINAL(name) decltype(glad_gl##name) name = nullptr;
+    RECORDED_FUNCTIONS(DECLARE_ORIGINAL)
+#undef DECLARE_ORIGINAL
+};
+
+OriginalFunctions original; // NOLINT
+
+std::FILE *captureFile = nullptr;    // NOLINT
+std::vector<unsigned char> buffer;   // NOLINT
+std::size_t commandStart = 0;        // NOLINT
+unsigned long long commandCount = 0; // NOLINT
+
+/// A buffer range mapped for writing: the application writes to `shadow`, which is copied into
+/// the real mapping and recorded as a BufferSubData when the buffer is unmapped
+struct WriteMapping
+{
+    GLenum target;
+    GLintptr offset;
+    void *pointer;
+    std::vector<unsigned char> shadow;
+};
+
+std::vector<WriteMapping> writeMappings; // NOLINT
+
+// Commands are buffered and written in large chunks
+constexpr std::size_t flushThreshold = 1 << 20;
+
+void Flush()
+{
+    std::fwrite(buffer.data(), 1, buffer.size(), captureFile);
+    buffer.clear();
+}
+
+template <typename T>
+void Put(T value)
+{
+    auto const *bytes = reinterpret_cast<unsigned char const *>(&value); // NOLINT
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));                // NOLINT
+}
+
+void PutBytes(void const *data, std::size_t size)
+{
+    auto const *bytes = static_cast<unsigned char const *>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size); // NOLINT
+}
+
+void BeginCommand(Op op)
+{
+    commandStart = buffer.size();
+    Put(static_cast<std::uint16_t>(op));
+    Put(std::uint32_t{0}); // Payload size, patched by EndCommand
+}
+
+void EndCommand()
+{
+    auto const size = static_cast<std::uint32_t>(buffer.size() - commandStart -
+                                                 App::GLCapture::commandHeaderSize);
+    std::memcpy(&buffer[commandStart + sizeof(std::uint16_t)], &size, sizeof(size));
+    ++commandCount;
+
+    if (buffer.size() >= flushThreshold)
+    {
+        Flush();
+    }
+}
+
+/// Record a call whose arguments are all plain values
+template <typename... Args>
+void RecordCall(Op op, Args... args)
+{
+    BeginCommand(op);
+    (Put(args), ...);
+    EndCommand();
+}
+
+/// Record a call generating `n` object names
+void RecordNames(Op op, GLsizei n, GLuint const *names)
+{
+    BeginCommand(op);
+    Put(n);
+    PutBytes(names, static_cast<std::size_t>(n) * sizeof(GLuint));
+    EndCommand();
+}
+
+/* Recording wrappers: call the driver, then append the call to the capture */
+
+void APIENTRY RecordGenVertexArrays(GLsizei n, GLuint *arrays)
+{
+    original.GenVertexArrays(n, arrays);
+    RecordNames(Op::GenVertexArrays, n, arrays);
+}
+
+void APIENTRY RecordDeleteVertexArrays(GLsizei n, GLuint const *arrays)
+{
+    original.DeleteVertexArrays(n, arrays);
+    RecordNames(Op::DeleteVertexArrays, n, arrays);
+}
+
+void APIENTRY RecordBindVertexArray(GLuint array)
+{
+    original.BindVertexArray(array);
+    RecordCall(Op::BindVertexArray, array);
+}
+
+void APIENTRY RecordGenBuffers(GLsizei n, GLuint *buffers)
+{
+    original.GenBuffers(n, buffers);
+    RecordNames(Op::GenBuffers, n, buffers);
+}
+
+void APIENTRY RecordDeleteBuffers(GLsizei n, GLuint const *buffers)
+{
+    original.DeleteBuffers(n, buffers);
+    RecordNames(Op::DeleteBuffers, n, buffers);
+}
+
+void APIENTRY RecordBindBuffer(GLenum target, GLuint buffer)
+{
+    original.BindBuffer(target, buffer);
+    RecordCall(Op::BindBuffer, target, buffer);
+}
+
+void APIENTRY RecordBufferData(GLenum target, GLsizeiptr size, void const *data, GLenum usage)
+{
+    original.BufferData(target, size, data, usage);
+
+    BeginCommand(Op::BufferData);
+    Put(target);
+    Put(static_cast<std::uint64_t>(size));
+    Put(usage);
+    Put(static_cast<std::uint8_t>(data != nullptr));
+    if (data != nullptr)
+    {
+        PutBytes(data, static_cast<std::size_t>(size));
+    }
+    EndCommand();
+}
+
+void APIENTRY RecordBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size,
+                                  void const *data)
+{
+    original.BufferSubData(target, offset, size, data);
+
+    BeginCommand(Op::BufferSubData);
+    Put(target);
+    Put(static_cast<std::uint64_t>(offset));
+    Put(static_cast<std::uint64_t>(size));
+    PutBytes(data, static_cast<std::size_t>(size));
+    EndCommand();
+}
+
+// Mapped writes are not calls, and a write-only mapping cannot be read back (its contents are
+// undefined to the CPU, and it may be uncached memory): hand the application a CPU copy instead,
+// and record what it wrote there as plain data when it unmaps (the capture has no notion of
+// mappings, and the replay needs none). Without GL_MAP_READ_BIT, the bytes of the range the
+// application does not write are recorded (and written) as zeros.
+void *APIENTRY RecordMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length,
+                                    GLbitfield access)
+{
+    void *pointer = original.MapBufferRange(target, offset, length, access);
+    if (pointer == nullptr || (access & GL_MAP_WRITE_BIT) == 0)
+    {
+        return pointer;
+    }
+
+    WriteMapping &mapping = writeMappings.emplace_back(WriteMapping{
+        target, offset, pointer, std::vector<unsigned char>(static_cast<std::size_t>(length))});
+    if ((access & GL_MAP_READ_BIT) != 0)
+    {
+        std::memcpy(mapping.shadow.data(), pointer, mapping.shadow.size());
+    }
+    return mapping.shadow.data();
+}
+
+GLboolean APIENTRY RecordUnmapBuffer(GLenum target)
+{
+    auto const mapping = std::find_if(writeMappings.begin(), writeMappings.end(),
+                                      [&](WriteMapping const &m) { return m.target == target; });
+    if (mapping != writeMappings.end())
+    {
+        std::memcpy(mapping->pointer, mapping->shadow.data(), mapping->shadow.size());
+
+        BeginCommand(Op::BufferSubData);
+        Put(target);
+        Put(static_cast<std::uint64_t>(mapping->offset));
+        Put(static_cast<std::uint64_t>(mapping->shadow.size()));
+        PutBytes(mapping->shadow.data(), mapping->shadow.size());
+        EndCommand();
+        writeMappings.erase(mapping);
+    }
+
+    return original.UnmapBuffer(target);
+}
+
+void APIENTRY RecordEnableVertexAttribArray(GLuint index)
+{
+    original.EnableVertexAttribArray(index);
+    RecordCall(Op::EnableVertexAttribArray, index);
+}
+
+void APIENTRY RecordDisableVertexAttribArray(GLuint index)
+{
+    original.DisableVertexAttribArray(index);
+    RecordCall(Op::DisableVertexAttribArray, index);
+}
+
+void APIENTRY RecordVertexAttribPointer(GLuint index, GLint size, GLenum type,
+                                        GLboolean normalized, GLsizei stride, void const *pointer)
+{
+    original.VertexAttribPointer(index, size, type, normalized, stride, pointer);
+    RecordCall(Op::VertexAttribPointer, index, size, type, static_cast<std::uint8_t>(normalized),
+               stride, reinterpret_cast<std::uint64_t>(pointer)); // NOLINT
+}
+
+GLuint APIENTRY RecordCreateShader(GLenum type)
+{
+    GLuint const shader = original.CreateShader(type);
+    RecordCall(Op::CreateShader, type, shader);
+    return shader;
+}
+
+void APIENTRY RecordShaderSource(GLuint shader, GLsizei count, GLchar const *const *string,
+                                 GLint const *length)
+{
+    original.ShaderSource(shader, count, string, length);
+
+    // Concatenate the strings into one source
+    std::string source;
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        if (length != nullptr && length[i] >= 0) // NOLINT
+        {
+            source.append(string[i], static_cast<std::size_t>(length[i])); // NOLINT
+        }
+        else
+        {
+            source.append(string[i]); // NOLINT
+        }
+    }
+
+    BeginCommand(Op::ShaderSource);
+    Put(shader);
+    Put(static_cast<std::uint32_t>(source.size()));
+    PutBytes(source.data(), source.size());
+    EndCommand();
+}
+
+void APIENTRY RecordCompileShader(GLuint shader)
+{
+    original.CompileShader(shader);
+    RecordCall(Op::CompileShader, shader);
+}
+
+void APIENTRY RecordDeleteShader(GLuint shader)
+{
+    original.DeleteShader(shader);
+    RecordCall(Op::DeleteShader, shader);
+}
+
+GLuint APIENTRY RecordCreateProgram()
+{
+    GLuint const program = original.CreateProgram();
+    RecordCall(Op::CreateProgram, program);
+    return program;
+}
+
+void APIENTRY RecordAttachShader(GLuint program, GLuint shader)
+{
+    original.AttachShader(program, shader);
+    RecordCall(Op::AttachShader, program, shader);
+}
+
+void APIENTRY RecordDetachShader(GLuint program, GLuint shader)
+{
+    original.DetachShader(program, shader);
+    RecordCall(Op::DetachShader, program, shader);
+}
+
+void APIENTRY RecordLinkProgram(GLuint program)
+{
+    original.LinkProgram(program);
+    RecordCall(Op::LinkProgram, program);
+}
+
+void APIENTRY RecordValidateProgram(GLuint program)
+{
+    original.ValidateProgram(program);
+    RecordCall(Op::ValidateProgram, program);
+}
+
+void APIENTRY RecordUseProgram(GLuint program)
+{
+    original.UseProgram(program);
+    RecordCall(Op::UseProgram, program);
+}
+
+void APIENTRY RecordDeleteProgram(GLuint program)
+{
+    original.DeleteProgram(program);
+    RecordCall(Op::DeleteProgram, program);
+}
+
+void APIENTRY RecordEnable(GLenum cap)
+{
+    original.Enable(cap);
+    RecordCall(Op::Enable, cap);
+}
+
+void APIENTRY RecordDisable(GLenum cap)
+{
+    original.Disable(cap);
+    RecordCall(Op::Disable, cap);
+}
+
+void APIENTRY RecordViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    original.Viewport(x, y, width, height);
+    RecordCall(Op::Viewport, x, y, width, height);
+}
+
+void APIENTRY RecordClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    original.ClearColor(red, green, blue, alpha);
+    RecordCall(Op::ClearColor, red, green, blue, alpha);
+}
+
+void APIENTRY RecordClear(GLbitfield mask)
+{
+    original.Clear(mask);
+    RecordCall(Op::Clear, mask);
+}
+
+void APIENTRY RecordDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    original.DrawArrays(mode, first, count);
+    RecordCall(Op::DrawArrays, mode, first, count);
+}
+
+void APIENTRY RecordDrawElements(GLenum mode, GLsizei count, GLenum type, void const *indices)
+{
+    original.DrawElements(mode, count, type, indices);
+    RecordCall(Op::DrawElements, mode, count, type,
+               reinterpret_cast<std::uint64_t>(indices)); // NOLINT
+}
+
+void APIENTRY RecordDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type,
+                                          void const *indices, GLsizei instanceCount)
+{
+    original.DrawElementsInstanced(mode, count, type, indices, instanceCount);
+    RecordCall(Op::DrawElementsInstanced, mode, count, type,
+               reinterpret_cast<std::uint64_t>(indices), instanceCount); // NOLINT
+}
+
+void APIENTRY RecordProgramUniform1i(GLuint program, GLint location, GLint v0)
+{
+    original.ProgramUniform1i(program, location, v0);
+    RecordCall(Op::ProgramUniform1i, program, location, v0);
+}
+
+void APIENTRY RecordProgramUniform1f(GLuint program, GLint location, GLfloat v0)
+{
+    original.ProgramUniform1f(program, location, v0);
+    RecordCall(Op::ProgramUniform1f, program, location, v0);
+}
+
+/// Record a glProgramUniform*fv call of `components` floats per element
+void RecordUniformVector(Op op, GLuint program, GLint location, GLsizei count,
+                         GLfloat const *value, std::size_t components)
+{
+    BeginCommand(op);
+    Put(program);
+    Put(location);
+    Put(count);
+    PutBytes(value, static_cast<std::size_t>(count) * components * sizeof(GLfloat));
+    EndCommand();
+}
+
+void APIENTRY RecordProgramUniform2fv(GLuint program, GLint location, GLsizei count,
+                                      GLfloat const *value)
+{
+    original.ProgramUniform2fv(program, location, count, value);
+    RecordUniformVector(Op::ProgramUniform2fv, program, location, count, value, 2);
+}
+
+void APIENTRY RecordProgramUniform3fv(GLuint program, GLint location, GLsizei count,
+                                      GLfloat const *value)
+{
+    original.ProgramUniform3fv(program, location, count, value);
+    RecordUniformVector(Op::ProgramUniform3fv, program, location, count, value, 3);
+}
+
+void APIENTRY RecordProgramUniform4fv(GLuint program, GLint location, GLsizei count,
+                                      GLfloat const *value)
+{
+    original.ProgramUniform4fv(program, location, count, value);
+    RecordUniformVector(Op::ProgramUniform4fv, program, location, count, value, 4);
+}
+
+void APIENTRY RecordProgramUniformMatrix4fv(GLuint program, GLint location, GLsizei count,
+                                            GLboolean transpose, GLfloat const *value)
+{
+    original.ProgramUniformMatrix4fv(program, location, count, transpose, value);
+
+    BeginCommand(Op::ProgramUniformMatrix4fv);
+    Put(program);
+    Put(location);
+    Put(count);
+    Put(static_cast<std::uint8_t>(transpose));
+    PutBytes(value, static_cast<std::size_t>(count) * 16 * sizeof(GLfloat));
+    EndCommand();
+}
+
+void APIENTRY RecordProgramParameteri(GLuint program, GLenum pname, GLint value)
+{
+    original.ProgramParameteri(program, pname, value);
+    RecordCall(Op::ProgramParameteri, program, pname, value);
+}
+
+void APIENTRY RecordGenProgramPipelines(GLsizei n, GLuint *pipelines)
+{
+    original.GenProgramPipelines(n, pipelines);
+    RecordNames(Op::GenProgramPipelines, n, pipelines);
+}
+
+void APIENTRY RecordDeleteProgramPipelines(GLsizei n, GLuint const *pipelines)
+{
+    original.DeleteProgramPipelines(n, pipelines);
+    RecordNames(Op::DeleteProgramPipelines, n, pipelines);
+}
+
+void APIENTRY RecordBindProgramPipeline(GLuint pipeline)
+{
+    original.BindProgramPipeline(pipeline);
+    RecordCall(Op::BindProgramPipeline, pipeline);
+}
+
+void APIENTRY RecordUseProgramStages(GLuint pipeline, GLbitfield stages, GLuint program)
+{
+    original.UseProgramStages(pipeline, stages, program);
+    RecordCall(Op::UseProgramStages, pipeline, stages, program);
+}
+
+void APIENTRY RecordDepthFunc(GLenum func)
+{
+    original.DepthFunc(func);
+    RecordCall(Op::DepthFunc, func);
+}
+
+void APIENTRY RecordDepthMask(GLboolean flag)
+{
+    original.DepthMask(flag);
+    RecordCall(Op::DepthMask, static_cast<std::uint8_t>(flag));
+}
+
+void APIENTRY RecordCullFace(GLenum mode)
+{
+    original.CullFace(mode);
+    RecordCall(Op::CullFace, mode);
+}
+
+void APIENTRY RecordFrontFace(GLenum mode)
+{
+    original.FrontFace(mode);
+    RecordCall(Op::FrontFace, mode);
+}
+
+void APIENTRY RecordBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    original.BlendFunc(sfactor, dfactor);
+    RecordCall(Op::BlendFunc, sfactor, dfactor);
+}
+
+void APIENTRY RecordGenFramebuffers(GLsizei n, GLuint *framebuffers)
+{
+    original.GenFramebuffers(n, framebuffers);
+    RecordNames(Op::GenFramebuffers, n, framebuffers);
+}
+
+void APIENTRY RecordDeleteFramebuffers(GLsizei n, GLuint const *framebuffers)
+{
+    original.DeleteFramebuffers(n, framebuffers);
+    RecordNames(Op::DeleteFramebuffers, n, framebuffers);
+}
+
+void APIENTRY RecordBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    original.BindFramebuffer(target, framebuffer);
+    RecordCall(Op::BindFramebuffer, target, framebuffer);
+}
+
+void APIENTRY RecordGenRenderbuffers(GLsizei n, GLuint *renderbuffers)
+{
+    original.GenRenderbuffers(n, renderbuffers);
+    RecordNames(Op::GenRenderbuffers, n, renderbuffers);
+}
+
+void APIENTRY RecordDeleteRenderbuffers(GLsizei n, GLuint const *renderbuffers)
+{
+    original.DeleteRenderbuffers(n, renderbuffers);
+    RecordNames(Op::DeleteRenderbuffers, n, renderbuffers);
+}
+
+void APIENTRY RecordBindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+    original.BindRenderbuffer(target, renderbuffer);
+    RecordCall(Op::BindRenderbuffer, target, renderbuffer);
+}
+
+void APIENTRY RecordRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width,
+                                        GLsizei height)
+{
+    original.RenderbufferStorage(target, internalformat, width, height);
+    RecordCall(Op::RenderbufferStorage, target, internalformat, width, height);
+}
+
+void APIENTRY RecordFramebufferRenderbuffer(GLenum target, GLenum attachment,
+                                            GLenum renderbuffertarget, GLuint renderbuffer)
+{
+    original.FramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+    RecordCall(Op::FramebufferRenderbuffer, target, attachment, renderbuffertarget, renderbuffer);
+}
+
+} // namespace
+
+bool App::GLRecorder::Start(char const *path, int width, int height)
+{
+    captureFile = std::fopen(path, "wb"); // NOLINT
+    if (captureFile == nullptr)
+    {
+        std::cerr << "Could not open capture file " << path << std::endl;
+        return false;
+    }
+
+    GLCapture::CaptureHeader const header{GLCapture::magic, GLCapture::version, width, height};
+    std::fwrite(&header, sizeof(header), 1, captureFile);
+    commandCount = 0;
+
+    // Route the calls through the recording wrappers
+#define HOOK(name)                                                                                 \
+    original.name = glad_gl##name;                                                                 \
+    glad_gl##name = Record##name;
+    RECORDED_FUNCTIONS(HOOK)
+#undef HOOK
+
+    std::cout << "Capturing OpenGL calls to " << path << std::endl;
+    return true;
+}
+
+void App::GLRecorder::Frame()
+{
+    if (captureFile == nullptr)
+    {
+        return;
+    }
+
+    BeginCommand(Op::Frame);
+    EndCommand();
+}
+
+void App::GLRecorder::Stop()
+{
+    if (captureFile == nullptr)
+    {
+        return;
+    }
+
+#define UNHOOK(name) glad_gl##name = original.name;
+    RECORDED_FUNCTIONS(UNHOOK)
+#undef UNHOOK
+
+    Flush();
+    std::fclose(captureFile); // NOLINT
+    captureFile = nullptr;
+
+    std::cout << "Captured " << commandCount << " OpenGL calls" << std::endl;
+}
+
+bool App::GLRecorder::IsRecording()
+{
+    return captureFile != nullptr;
+}
@@ -0,0 +1,169 @@
+#include <array>
+
+#include "glad/glad.h"
+
+#include "App/GpuTimer.h"
+
+namespace {
+
+constexpr std::size_t passCount = static_cast<std::size_t>(App::GpuTimer::Pass::Count);
+
+/// One GL_TIME_ELAPSED query of one pass in one frame of the ring
+struct QuerySlot
+{
+    GLuint query = 0;
+    bool pending = false; // Issued but its result has not been read back yet
+    bool active = false;  // Between Begin and End in the current frame
+};
+
+std::array<std::array<QuerySlot, passCount>, App::GpuTimer::ringSize> ring{}; // NOLINT
+std::array<App::FrameStats::RollingWindow, passCount> passWindows;             // NOLINT
+
+std::size_t frameSlot = 0; // NOLINT
+bool initialized = false;  // NOLINT
+
+/// Read back the result of a pending query if (and only if) the GPU is done with it
+///
+/// @return void
+void Collect(QuerySlot &slot, App::FrameStats::RollingWindow &window)
+{
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(slot.query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE)
+    {
+        return;
+    }
+
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(slot.query, GL_QUERY_RESULT, &elapsed);
+    window.Record(elapsed);
+    slot.pending = false;
+}
+
+} // namespace
+
+void App::GpuTimer::Initialize()
+{
+    for (auto &frame : ring)
+    {
+        for (QuerySlot &slot : frame)
+        {
+            glGenQueries(1, &slot.query);
+        }
+    }
+
+    frameSlot = 0;
+    initialized = true;
+}
+
+void App::GpuTimer::CleanUp()
+{
+    if (!initialized)
+    {
+        return;
+    }
+
+    for (auto &frame : ring)
+    {
+        for (QuerySlot &slot : frame)
+        {
+            glDeleteQueries(1, &slot.query);
+            slot = QuerySlot{};
+        }
+    }
+
+    initialized = false;
+}
+
+void App::GpuTimer::Begin(Pass pass)
+{
+    if (!initialized)
+    {
+        return;
+    }
+
+    QuerySlot &slot = ring[frameSlot][static_cast<std::size_t>(pass)]; // NOLINT
+
+    // The GPU is more than `ringSize` frames behind: rather than waiting for the old result we skip
+    // measuring this pass for this frame
+    if (slot.pending)
+    {
+        return;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, slot.query);
+    slot.active = true;
+}
+
+void App::GpuTimer::End(Pass pass)
+{
+    QuerySlot &slot = ring[frameSlot][static_cast<std::size_t>(pass)]; // NOLINT
+    if (!slot.active)
+    {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED);
+    slot.active = false;
+    slot.pending = true;
+}
+
+void App::GpuTimer::EndFrame()
+{
+    if (!initialized)
+    {
+        return;
+    }
+
+    // Poll every slot still in flight (oldest results are most likely to be ready)
+    for (std::size_t i = 1; i <= ringSize; ++i)
+    {
+        auto &frame = ring[(frameSlot + i) % ringSize]; // NOLINT
+        for (std::size_t pass = 0; pass < passCount; ++pass)
+        {
+            if (frame[pass].pending) // NOLINT
+            {
+                Collect(frame[pass], passWindows[pass]); // NOLINT
+            }
+        }
+    }
+
+    frameSlot = (frameSlot + 1) % ringSize;
+}
+
+App::FrameStats::Summary App::GpuTimer::Query(Pass pass)
+{
+    return passWindows[static_cast<std::size_t>(pass)].Summarize(); // NOLINT
+}
+
+void App::GpuTimer::Reset()
+{
+    for (auto &window : passWindows)
+    {
+        window.Reset();
+    }
+}
+
+void App::GpuTimer::Dump(std::ostream &out)
+{
+    for (std::size_t i = 0; i < passCount; ++i)
+    {
+        auto const pass = static_cast<Pass>(i);
+        FrameStats::DumpRow(out, PassName(pass), Query(pass));
+    }
+}
+
+char const *App::GpuTimer::PassName(Pass pass)
+{
+    switch (pass)
+    {
+        case Pass::PreDraw:
+            return "GPU PreDraw";
+        case Pass::Draw:
+            return "GPU Draw";
+        case Pass::Count:
+            break;
+    }
+
+    return "?";
+}
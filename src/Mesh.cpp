@@ -0,0 +1,1185 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "App/Mesh.h"
+#include "App/Trace.h"
+
+namespace {
+
+using App::Mesh::Mesh;
+using App::Mesh::Vertex;
+
+using Vec3 = std::array<GLfloat, 3>;
+
+constexpr Vec3 white = {1.0F, 1.0F, 1.0F};
+
+unsigned ThreadCount(unsigned requested)
+{
+    return requested != 0 ? requested : std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+/// Run `work(0)` ... `work(count - 1)` on `count` threads (the calling thread runs `work(0)`)
+template <typename Work>
+void Parallel(unsigned count, Work work)
+{
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < count; ++i)
+    {
+        workers.emplace_back(work, i);
+    }
+    work(0U);
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+/// Read a whole file at once
+///
+/// @return bool whether the file could be read
+bool ReadFile(std::filesystem::path const &path, std::string &contents)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    contents.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+    return static_cast<bool>(file);
+}
+
+//- Vertex deduplication
+
+/// Open addressing (linear probing) table of the indices of distinct vertices, by contents. The
+/// capacity is a power of two, at most half used.
+class VertexTable
+{
+  public:
+    explicit VertexTable(std::size_t expected)
+    {
+        std::size_t capacity = 64;
+        while (capacity < expected * 2)
+        {
+            capacity *= 2;
+        }
+        slots.assign(capacity, empty);
+    }
+
+    /// The index of the vertex equal to `vertex` in `vertices`, where it is appended if new
+    GLuint Insert(Vertex const &vertex, std::vector<Vertex> &vertices)
+    {
+        if ((vertices.size() + 1) * 2 > slots.size())
+        {
+            Grow(vertices);
+        }
+
+        std::size_t const mask = slots.size() - 1;
+        for (std::size_t i = Hash(vertex) & mask;; i = (i + 1) & mask)
+        {
+            if (slots[i] == empty)
+            {
+                slots[i] = static_cast<GLuint>(vertices.size());
+                vertices.push_back(vertex);
+                return slots[i];
+            }
+            if (std::memcmp(&vertices[slots[i]], &vertex, sizeof(Vertex)) == 0)
+            {
+                return slots[i];
+            }
+        }
+    }
+
+  private:
+    static constexpr GLuint empty = std::numeric_limits<GLuint>::max();
+
+    std::vector<GLuint> slots;
+
+    static std::size_t Hash(Vertex const &vertex)
+    {
+        std::array<std::uint32_t, sizeof(Vertex) / sizeof(std::uint32_t)> words{};
+        std::memcpy(words.data(), &vertex, sizeof(Vertex));
+
+        std::uint64_t hash = 0;
+        for (std::uint32_t const word : words)
+        {
+            hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+            hash ^= hash >> 29U;
+        }
+        return static_cast<std::size_t>(hash);
+    }
+
+    void Grow(std::vector<Vertex> const &vertices)
+    {
+        slots.assign(slots.size() * 2, empty);
+        std::size_t const mask = slots.size() - 1;
+        for (std::size_t v = 0; v < vertices.size(); ++v)
+        {
+            std::size_t i = Hash(vertices[v]) & mask;
+            while (slots[i] != empty)
+            {
+                i = (i + 1) & mask;
+            }
+            slots[i] = static_cast<GLuint>(v);
+        }
+    }
+};
+
+//- Streaming tokenizer
+
+/// Reads the tokens of one line at a time out of a chunk of text, without copying
+struct Tokenizer
+{
+    char const *p;
+    char const *end;
+
+    bool AtEnd() const
+    {
+        return p == end;
+    }
+
+    void SkipSpaces()
+    {
+        while (p != end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        {
+            ++p; // NOLINT
+        }
+    }
+
+    /// Move to the start of the next line
+    void NextLine()
+    {
+        p = std::find(p, end, '\n');
+        if (p != end)
+        {
+            ++p; // NOLINT
+        }
+    }
+
+    /// The next whitespace separated token of the line (empty at the end of the line)
+    std::string_view Token()
+    {
+        SkipSpaces();
+        char const *start = p;
+        while (p != end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+        {
+            ++p; // NOLINT
+        }
+        return {start, static_cast<std::size_t>(p - start)};
+    }
+
+    bool Float(GLfloat &value)
+    {
+        std::string_view const token = Token();
+        auto const result = std::from_chars(token.data(), token.data() + token.size(), value);
+        return !token.empty() && result.ec == std::errc{};
+    }
+};
+
+//- Wavefront OBJ
+
+constexpr std::int64_t noNormal = std::numeric_limits<std::int64_t>::min();
+
+/// A corner of a triangle: its position and normal by index, either into the whole file or, for the
+/// relative indices of the file, relative to the first position (normal) of the chunk. A relative
+/// index is negative when it refers to an earlier chunk: it is only resolved once the chunk's base
+/// is known.
+struct ObjCorner
+{
+    std::int64_t position = 0;
+    std::int64_t normal = noNormal;
+    bool positionRelative = false;
+    bool normalRelative = false;
+};
+
+/// One chunk of lines of an OBJ file, parsed by one thread
+struct ObjChunk
+{
+    std::string_view text;
+    std::string error;
+
+    std::vector<Vec3> positions;
+    std::vector<Vec3> colors; // Empty if no position of the chunk has a color
+    std::vector<Vec3> normals;
+    std::vector<ObjCorner> corners; // Three per triangle
+
+    std::size_t positionBase = 0; // Index of the first position (normal) of the chunk in the file
+    std::size_t normalBase = 0;
+
+    std::vector<Vertex> vertices; // Distinct vertices of the chunk
+    std::vector<GLuint> indices;  // Into `vertices`
+};
+
+/// Parse a face index (1-based, negative for relative) into a corner index
+///
+/// @param count the number of positions (normals) of the chunk so far
+/// @param relative set when the index is relative to the start of the chunk
+/// @return bool whether the index is a number other than 0 (its range is checked once resolved)
+bool ObjIndex(std::string_view text, std::size_t count, std::int64_t &index, bool &relative)
+{
+    std::int64_t value = 0;
+    auto const result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (text.empty() || result.ec != std::errc{} || value == 0)
+    {
+        return false;
+    }
+
+    relative = value < 0;
+    index = relative ? static_cast<std::int64_t>(count) + value : value - 1;
+    return true;
+}
+
+void ParseObjChunk(ObjChunk &chunk)
+{
+    Tokenizer in{chunk.text.data(), chunk.text.data() + chunk.text.size()};
+    std::vector<ObjCorner> polygon;
+
+    for (; !in.AtEnd(); in.NextLine())
+    {
+        std::string_view const keyword = in.Token();
+        if (keyword == "v")
+        {
+            Vec3 position{};
+            Vec3 color = white;
+            if (!in.Float(position[0]) || !in.Float(position[1]) || !in.Float(position[2]))
+            {
+                chunk.error = "malformed vertex position";
+                return;
+            }
+
+            // Vertex colors are an extension: "v x y z r g b"
+            bool const hasColor = in.Float(color[0]) && in.Float(color[1]) && in.Float(color[2]);
+            if (hasColor || !chunk.colors.empty())
+            {
+                chunk.colors.resize(chunk.positions.size(), white);
+                chunk.colors.push_back(hasColor ? color : white);
+            }
+            chunk.positions.push_back(position);
+        }
+        else if (keyword == "vn")
+        {
+            Vec3 normal{};
+            if (!in.Float(normal[0]) || !in.Float(normal[1]) || !in.Float(normal[2]))
+            {
+                chunk.error = "malformed vertex normal";
+                return;
+            }
+            chunk.normals.push_back(normal);
+        }
+        else if (keyword == "f")
+        {
+            // v, v/vt, v//vn or v/vt/vn (texture coordinates are not used)
+            polygon.clear();
+            for (std::string_view corner = in.Token(); !corner.empty(); corner = in.Token())
+            {
+                std::size_t const slash = corner.find('/');
+                std::size_t const secondSlash =
+                    slash == std::string_view::npos ? slash : corner.find('/', slash + 1);
+
+                ObjCorner indices{};
+                bool valid = ObjIndex(corner.substr(0, slash), chunk.positions.size(),
+                                      indices.position, indices.positionRelative);
+                if (secondSlash != std::string_view::npos)
+                {
+                    valid = valid && ObjIndex(corner.substr(secondSlash + 1), chunk.normals.size(),
+                                              indices.normal, indices.normalRelative);
+                }
+                if (!valid)
+                {
+                    chunk.error = "malformed face \"" + std::string{corner} + "\"";
+                    return;
+                }
+                polygon.push_back(indices);
+            }
+
+            // Triangulate polygons as fans
+            for (std::size_t i = 2; i < polygon.size(); ++i)
+            {
+                chunk.corners.insert(chunk.corners.end(), {polygon[0], polygon[i - 1], polygon[i]});
+            }
+        }
+
+        // Anything else (texture coordinates, groups, materials, ...) is ignored
+    }
+}
+
+/// Resolve the corners of a chunk into vertices, merging the identical ones of the chunk
+void BuildObjChunk(ObjChunk &chunk, std::vector<Vec3> const &positions,
+                   std::vector<Vec3> const &colors, std::vector<Vec3> const &normals)
+{
+    // Into the whole file, -1 if out of range
+    auto const resolve = [](std::int64_t index, bool relative, std::size_t base, std::size_t size) {
+        std::int64_t const resolved = relative ? static_cast<std::int64_t>(base) + index : index;
+        return resolved >= 0 && resolved < static_cast<std::int64_t>(size) ? resolved : -1;
+    };
+
+    VertexTable table(chunk.corners.size() / 3);
+    chunk.indices.reserve(chunk.corners.size());
+    for (ObjCorner const &corner : chunk.corners)
+    {
+        bool const hasNormal = corner.normal != noNormal;
+        std::int64_t const position = resolve(corner.position, corner.positionRelative,
+                                              chunk.positionBase, positions.size());
+        std::int64_t const normal =
+            hasNormal ? resolve(corner.normal, corner.normalRelative, chunk.normalBase,
+                                normals.size())
+                      : 0;
+        if (position < 0 || normal < 0)
+        {
+            chunk.error = "face index out of range";
+            return;
+        }
+
+        auto const p = static_cast<std::size_t>(position);
+        Vertex const vertex{positions[p], colors.empty() ? white : colors[p],
+                            hasNormal ? normals[static_cast<std::size_t>(normal)] : Vec3{}};
+        chunk.indices.push_back(table.Insert(vertex, chunk.vertices));
+    }
+    chunk.corners = {};
+}
+
+bool LoadObj(std::string const &text, Mesh &mesh, unsigned threads)
+{
+    // Split the file into one chunk of whole lines per thread
+    unsigned const chunkCount =
+        std::clamp<unsigned>(static_cast<unsigned>(text.size() / (1U << 16U)), 1, threads);
+    std::vector<ObjChunk> chunks(chunkCount);
+    std::size_t start = 0;
+    for (unsigned i = 0; i < chunkCount; ++i)
+    {
+        std::size_t end = text.size() * (i + 1) / chunkCount;
+        end = end >= text.size() ? text.size() : std::min(text.find('\n', end), text.size());
+        end = std::max(end, start);
+        chunks[i].text = std::string_view{text}.substr(start, end - start);
+        start = std::min(end + 1, text.size());
+    }
+
+    {
+        TRACE_SCOPE("Mesh::ParseObj");
+        Parallel(chunkCount, [&](unsigned i) { ParseObjChunk(chunks[i]); });
+    }
+
+    // Relative indices and the vertices of later chunks need the positions of the whole file
+    std::vector<Vec3> positions;
+    std::vector<Vec3> colors;
+    std::vector<Vec3> normals;
+    bool const hasColors = std::any_of(chunks.begin(), chunks.end(),
+                                       [](ObjChunk const &chunk) { return !chunk.colors.empty(); });
+    for (ObjChunk &chunk : chunks)
+    {
+        if (!chunk.error.empty())
+        {
+            std::cerr << "OBJ: " << chunk.error << std::endl;
+            return false;
+        }
+
+        chunk.positionBase = positions.size();
+        chunk.normalBase = normals.size();
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+        if (hasColors)
+        {
+            chunk.colors.resize(chunk.positions.size(), white);
+            colors.insert(colors.end(), chunk.colors.begin(), chunk.colors.end());
+        }
+        chunk.positions = {};
+        chunk.colors = {};
+        chunk.normals = {};
+    }
+
+    {
+        TRACE_SCOPE("Mesh::BuildObj");
+        Parallel(chunkCount,
+                 [&](unsigned i) { BuildObjChunk(chunks[i], positions, colors, normals); });
+    }
+
+    // Merge the vertices of the chunks (only the ones shared by several chunks are duplicates)
+    std::size_t indexCount = 0;
+    std::size_t vertexCount = 0;
+    for (ObjChunk const &chunk : chunks)
+    {
+        if (!chunk.error.empty())
+        {
+            std::cerr << "OBJ: " << chunk.error << std::endl;
+            return false;
+        }
+        indexCount += chunk.indices.size();
+        vertexCount += chunk.vertices.size();
+    }
+
+    VertexTable table(vertexCount);
+    mesh.vertices.reserve(vertexCount);
+    mesh.indices.resize(indexCount);
+    std::vector<std::vector<GLuint>> remaps(chunkCount);
+    for (unsigned i = 0; i < chunkCount; ++i)
+    {
+        remaps[i].reserve(chunks[i].vertices.size());
+        for (Vertex const &vertex : chunks[i].vertices)
+        {
+            remaps[i].push_back(table.Insert(vertex, mesh.vertices));
+        }
+    }
+
+    std::vector<std::size_t> indexBases(chunkCount, 0);
+    for (unsigned i = 1; i < chunkCount; ++i)
+    {
+        indexBases[i] = indexBases[i - 1] + chunks[i - 1].indices.size();
+    }
+    Parallel(chunkCount, [&](unsigned i) {
+        std::transform(chunks[i].indices.begin(), chunks[i].indices.end(),
+                       mesh.indices.begin() + static_cast<long>(indexBases[i]),
+                       [&](GLuint index) { return remaps[i][index]; });
+    });
+
+    return true;
+}
+
+//- glTF binary (.glb)
+
+/// A parsed JSON value
+struct Json
+{
+    enum class Type : std::uint8_t
+    {
+        Null,
+        Boolean,
+        Number,
+        String,
+        Array,
+        Object,
+    };
+
+    Type type = Type::Null;
+    double number = 0.0; // Also 0/1 for booleans
+    std::string string;
+    std::vector<Json> items;       // Array elements, object values
+    std::vector<std::string> keys; // Object keys (same order as `items`)
+
+    Json const *Find(std::string_view key) const
+    {
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            if (keys[i] == key)
+            {
+                return &items[i];
+            }
+        }
+        return nullptr;
+    }
+
+    /// The number at `key`, `fallback` if there is none
+    double Number(std::string_view key, double fallback) const
+    {
+        Json const *value = Find(key);
+        return value != nullptr && value->type == Type::Number ? value->number : fallback;
+    }
+};
+
+/// Recursive descent JSON parser (glTF only needs the basics)
+struct JsonParser
+{
+    std::string_view text;
+    std::size_t position = 0;
+
+    static constexpr int maxDepth = 64;
+
+    void SkipSpaces()
+    {
+        while (position < text.size() && std::string_view{" \t\r\n"}.find(text[position]) !=
+                                             std::string_view::npos)
+        {
+            ++position;
+        }
+    }
+
+    bool Expect(char c)
+    {
+        SkipSpaces();
+        if (position < text.size() && text[position] == c)
+        {
+            ++position;
+            return true;
+        }
+        return false;
+    }
+
+    bool String(std::string &out)
+    {
+        if (!Expect('"'))
+        {
+            return false;
+        }
+        while (position < text.size() && text[position] != '"')
+        {
+            char c = text[position++];
+            if (c == '\\' && position < text.size())
+            {
+                char const escaped = text[position++];
+                c = escaped == 'n' ? '\n' : escaped == 't' ? '\t' : escaped;
+                if (escaped == 'u') // Names in glTF files are ASCII in practice
+                {
+                    position += 4;
+                    c = '?';
+                }
+            }
+            out += c;
+        }
+        return Expect('"');
+    }
+
+    bool Value(Json &value, int depth)
+    {
+        SkipSpaces();
+        if (position >= text.size() || depth > maxDepth)
+        {
+            return false;
+        }
+
+        char const c = text[position];
+        if (c == '{')
+        {
+            value.type = Json::Type::Object;
+            ++position;
+            if (Expect('}'))
+            {
+                return true;
+            }
+            do
+            {
+                value.keys.emplace_back();
+                value.items.emplace_back();
+                if (!String(value.keys.back()) || !Expect(':') ||
+                    !Value(value.items.back(), depth + 1))
+                {
+                    return false;
+                }
+            } while (Expect(','));
+            return Expect('}');
+        }
+        if (c == '[')
+        {
+            value.type = Json::Type::Array;
+            ++position;
+            if (Expect(']'))
+            {
+                return true;
+            }
+            do
+            {
+                value.items.emplace_back();
+                if (!Value(value.items.back(), depth + 1))
+                {
+                    return false;
+                }
+            } while (Expect(','));
+            return Expect(']');
+        }
+        if (c == '"')
+        {
+            value.type = Json::Type::String;
+            return String(value.string);
+        }
+        for (std::string_view const word : {"true", "false", "null"})
+        {
+            if (text.substr(position).starts_with(word))
+            {
+                position += word.size();
+                value.type = word == "null" ? Json::Type::Null : Json::Type::Boolean;
+                value.number = word == "true" ? 1.0 : 0.0;
+                return true;
+            }
+        }
+
+        value.type = Json::Type::Number;
+        char const *begin = text.data() + position;
+        auto const result = std::from_chars(begin, text.data() + text.size(), value.number);
+        position += static_cast<std::size_t>(result.ptr - begin);
+        return result.ec == std::errc{};
+    }
+};
+
+/// Where the elements of an accessor are in the binary chunk
+struct Accessor
+{
+    unsigned char const *data = nullptr;
+    std::size_t count = 0;
+    std::size_t stride = 0;
+    std::size_t components = 0;
+    GLenum componentType = 0;
+    bool normalized = false;
+
+    /// Component `c` of element `i` as a float (normalized integers scaled to [0, 1] or [-1, 1])
+    GLfloat Float(std::size_t i, std::size_t c) const
+    {
+        unsigned char const *p = data + (i * stride); // NOLINT
+        auto const read = [&]<typename T>(T) {
+            T value;
+            std::memcpy(&value, p + (c * sizeof(T)), sizeof(T)); // NOLINT
+            if constexpr (std::is_integral_v<T>)
+            {
+                if (normalized)
+                {
+                    return std::max(static_cast<GLfloat>(value) /
+                                        static_cast<GLfloat>(std::numeric_limits<T>::max()),
+                                    -1.0F);
+                }
+            }
+            return static_cast<GLfloat>(value);
+        };
+
+        switch (componentType)
+        {
+            case GL_BYTE:
+                return read(std::int8_t{});
+            case GL_UNSIGNED_BYTE:
+                return read(std::uint8_t{});
+            case GL_SHORT:
+                return read(std::int16_t{});
+            case GL_UNSIGNED_SHORT:
+                return read(std::uint16_t{});
+            case GL_UNSIGNED_INT:
+                return read(std::uint32_t{});
+            default:
+                return read(GLfloat{});
+        }
+    }
+
+    GLuint Index(std::size_t i) const
+    {
+        unsigned char const *p = data + (i * stride); // NOLINT
+        switch (componentType)
+        {
+            case GL_UNSIGNED_BYTE:
+                return *p;
+            case GL_UNSIGNED_SHORT:
+            {
+                std::uint16_t value = 0;
+                std::memcpy(&value, p, sizeof(value));
+                return value;
+            }
+            default:
+            {
+                std::uint32_t value = 0;
+                std::memcpy(&value, p, sizeof(value));
+                return value;
+            }
+        }
+    }
+};
+
+std::size_t ComponentSize(GLenum componentType)
+{
+    switch (componentType)
+    {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+            return 2;
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+/// Locate an accessor in the binary chunk (which must hold all of it)
+///
+/// @return bool whether the accessor is valid and supported
+bool FindAccessor(Json const &document, std::string_view bin, double index, Accessor &accessor)
+{
+    Json const *accessors = document.Find("accessors");
+    Json const *views = document.Find("bufferViews");
+    auto const at = [](Json const *array, double i) -> Json const * {
+        return array != nullptr && i >= 0 && i < static_cast<double>(array->items.size())
+                   ? &array->items[static_cast<std::size_t>(i)]
+                   : nullptr;
+    };
+
+    Json const *a = at(accessors, index);
+    Json const *view = a != nullptr ? at(views, a->Number("bufferView", -1)) : nullptr;
+    Json const *type = a != nullptr ? a->Find("type") : nullptr;
+    if (view == nullptr || type == nullptr || a->Find("sparse") != nullptr ||
+        view->Number("buffer", 0) != 0)
+    {
+        return false;
+    }
+
+    std::string_view const typeName = type->string;
+    accessor.components = typeName == "SCALAR" ? 1
+                          : typeName == "VEC2" ? 2
+                          : typeName == "VEC3" ? 3
+                          : typeName == "VEC4" ? 4
+                                               : 0;
+    accessor.componentType = static_cast<GLenum>(a->Number("componentType", 0));
+    accessor.count = static_cast<std::size_t>(a->Number("count", 0));
+    Json const *normalized = a->Find("normalized");
+    accessor.normalized = normalized != nullptr && normalized->number != 0.0;
+
+    std::size_t const elementSize = accessor.components * ComponentSize(accessor.componentType);
+    auto const stride = static_cast<std::size_t>(view->Number("byteStride", 0));
+    accessor.stride = stride != 0 ? stride : elementSize;
+    auto const offset = static_cast<std::size_t>(view->Number("byteOffset", 0) +
+                                                 a->Number("byteOffset", 0));
+    if (elementSize == 0 || accessor.count == 0 ||
+        offset + (accessor.stride * (accessor.count - 1)) + elementSize > bin.size())
+    {
+        return false;
+    }
+
+    accessor.data = reinterpret_cast<unsigned char const *>(bin.data()) + offset; // NOLINT
+    return true;
+}
+
+/// One triangle list of a glTF mesh, converted by one thread
+struct GltfPrimitive
+{
+    Json const *json;
+    std::string error;
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices;
+};
+
+void LoadGltfPrimitive(Json const &document, std::string_view bin, GltfPrimitive &primitive)
+{
+    Json const *attributes = primitive.json->Find("attributes");
+    Json const *position = attributes != nullptr ? attributes->Find("POSITION") : nullptr;
+    if (position == nullptr || primitive.json->Number("mode", GL_TRIANGLES) != GL_TRIANGLES)
+    {
+        primitive.error = "only triangle lists with positions are supported";
+        return;
+    }
+
+    Accessor positions;
+    Accessor normals;
+    Accessor colors;
+    Json const *normal = attributes->Find("NORMAL");
+    Json const *color = attributes->Find("COLOR_0");
+    if (!FindAccessor(document, bin, position->number, positions) || positions.components != 3 ||
+        (normal != nullptr && !FindAccessor(document, bin, normal->number, normals)) ||
+        (color != nullptr && !FindAccessor(document, bin, color->number, colors)))
+    {
+        primitive.error = "invalid or unsupported accessor";
+        return;
+    }
+
+    primitive.vertices.resize(positions.count);
+    for (std::size_t i = 0; i < positions.count; ++i)
+    {
+        Vertex &vertex = primitive.vertices[i];
+        for (std::size_t c = 0; c < 3; ++c)
+        {
+            vertex.position[c] = positions.Float(i, c);
+            vertex.normal[c] = normal != nullptr && i < normals.count ? normals.Float(i, c) : 0.0F;
+            vertex.color[c] = color != nullptr && i < colors.count ? colors.Float(i, c) : 1.0F;
+        }
+    }
+
+    Accessor indices;
+    Json const *indicesIndex = primitive.json->Find("indices");
+    if (indicesIndex == nullptr)
+    {
+        primitive.indices.resize(positions.count - (positions.count % 3));
+        for (std::size_t i = 0; i < primitive.indices.size(); ++i)
+        {
+            primitive.indices[i] = static_cast<GLuint>(i);
+        }
+        return;
+    }
+    if (!FindAccessor(document, bin, indicesIndex->number, indices) || indices.components != 1)
+    {
+        primitive.error = "invalid index accessor";
+        return;
+    }
+
+    primitive.indices.resize(indices.count - (indices.count % 3));
+    for (std::size_t i = 0; i < primitive.indices.size(); ++i)
+    {
+        primitive.indices[i] = indices.Index(i);
+        if (primitive.indices[i] >= positions.count)
+        {
+            primitive.error = "vertex index out of range";
+            return;
+        }
+    }
+}
+
+bool LoadGlb(std::string const &file, Mesh &mesh, unsigned threads)
+{
+    constexpr std::uint32_t glbMagic = 0x46546C67; // "glTF"
+    constexpr std::uint32_t jsonChunk = 0x4E4F534A;
+    constexpr std::uint32_t binChunk = 0x004E4942;
+
+    auto const read32 = [&](std::size_t offset) {
+        std::uint32_t value = 0;
+        std::memcpy(&value, file.data() + offset, sizeof(value));
+        return value;
+    };
+
+    if (file.size() < 20 || read32(0) != glbMagic || read32(4) != 2)
+    {
+        std::cerr << "glTF: not a version 2 binary glTF file" << std::endl;
+        return false;
+    }
+
+    std::string_view json;
+    std::string_view bin;
+    for (std::size_t offset = 12; offset + 8 <= file.size();)
+    {
+        std::size_t const length = read32(offset);
+        std::uint32_t const type = read32(offset + 4);
+        offset += 8;
+        if (offset + length > file.size())
+        {
+            std::cerr << "glTF: truncated chunk" << std::endl;
+            return false;
+        }
+        if (type == jsonChunk)
+        {
+            json = std::string_view{file}.substr(offset, length);
+        }
+        else if (type == binChunk)
+        {
+            bin = std::string_view{file}.substr(offset, length);
+        }
+        offset += length;
+    }
+
+    Json document;
+    JsonParser parser{json};
+    if (json.empty() || !parser.Value(document, 0) || document.type != Json::Type::Object)
+    {
+        std::cerr << "glTF: invalid JSON chunk" << std::endl;
+        return false;
+    }
+
+    // Every primitive of every mesh (node transforms are not applied)
+    std::vector<GltfPrimitive> primitives;
+    if (Json const *meshes = document.Find("meshes"))
+    {
+        for (Json const &m : meshes->items)
+        {
+            if (Json const *list = m.Find("primitives"))
+            {
+                for (Json const &primitive : list->items)
+                {
+                    primitives.push_back({&primitive, {}, {}, {}});
+                }
+            }
+        }
+    }
+    if (primitives.empty())
+    {
+        std::cerr << "glTF: no mesh" << std::endl;
+        return false;
+    }
+
+    {
+        TRACE_SCOPE("Mesh::LoadGltf");
+        std::atomic<std::size_t> next{0};
+        Parallel(std::min<unsigned>(threads, static_cast<unsigned>(primitives.size())),
+                 [&](unsigned) {
+                     for (std::size_t i = next++; i < primitives.size(); i = next++)
+                     {
+                         LoadGltfPrimitive(document, bin, primitives[i]);
+                     }
+                 });
+    }
+
+    for (GltfPrimitive &primitive : primitives)
+    {
+        if (!primitive.error.empty())
+        {
+            std::cerr << "glTF: " << primitive.error << std::endl;
+            return false;
+        }
+
+        auto const base = static_cast<GLuint>(mesh.vertices.size());
+        mesh.vertices.insert(mesh.vertices.end(), primitive.vertices.begin(),
+                             primitive.vertices.end());
+        for (GLuint const index : primitive.indices)
+        {
+            mesh.indices.push_back(base + index);
+        }
+    }
+
+    // Exporters often split vertices that are identical
+    App::Mesh::Deduplicate(mesh);
+    return true;
+}
+
+//- Vertex formats
+
+/// A vertex of the float format
+struct FloatVertex
+{
+    std::array<GLfloat, 3> position;
+    std::array<GLfloat, 3> color;
+};
+
+static_assert(sizeof(FloatVertex) == 24, "float vertices are uploaded as they are");
+
+/// A vertex of the compact formats (attributes 4 bytes aligned)
+struct CompactVertex
+{
+    std::array<std::uint16_t, 4> position; // Half floats or snorm16 (the fourth is padding)
+    std::array<std::uint8_t, 4> color;     // unorm8 (alpha is 1)
+};
+
+static_assert(sizeof(CompactVertex) == 12, "compact vertices are uploaded as they are");
+
+/// Round a float to the nearest half float (too small values become 0, too large ones infinity)
+std::uint16_t ToHalf(GLfloat value)
+{
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    auto const sign = static_cast<std::uint16_t>((bits >> 16U) & 0x8000U);
+    int const exponent = static_cast<int>((bits >> 23U) & 0xFFU) - 127 + 15;
+    std::uint32_t const mantissa = bits & 0x7FFFFFU;
+    if (exponent <= 0)
+    {
+        return sign;
+    }
+    if (exponent >= 31)
+    {
+        return static_cast<std::uint16_t>(sign | 0x7C00U);
+    }
+
+    // Round to nearest even (a carry into the exponent is still the right value)
+    auto half = static_cast<std::uint32_t>(sign | (static_cast<std::uint32_t>(exponent) << 10U) |
+                                           (mantissa >> 13U));
+    std::uint32_t const rest = mantissa & 0x1FFFU;
+    if (rest > 0x1000U || (rest == 0x1000U && (half & 1U) != 0))
+    {
+        ++half;
+    }
+    return static_cast<std::uint16_t>(half);
+}
+
+/// Quantize a value in [-1, 1] (OpenGL 4.2 and later decode c as max(c / 32767, -1); 4.1 as
+/// (2c + 1) / 65535, which differs by less than one step)
+std::int16_t ToSnorm16(GLfloat value)
+{
+    return static_cast<std::int16_t>(std::lround(std::clamp(value, -1.0F, 1.0F) * 32767.0F));
+}
+
+std::uint8_t ToUnorm8(GLfloat value)
+{
+    return static_cast<std::uint8_t>(std::lround(std::clamp(value, 0.0F, 1.0F) * 255.0F));
+}
+
+} // namespace
+
+std::size_t App::Mesh::VertexSize(VertexFormat format)
+{
+    return format == VertexFormat::Float ? sizeof(FloatVertex) : sizeof(CompactVertex);
+}
+
+std::array<App::Mesh::AttributeFormat, 2> App::Mesh::Attributes(VertexFormat format)
+{
+    switch (format)
+    {
+        case VertexFormat::Half:
+            return {{{3, GL_HALF_FLOAT, GL_FALSE, offsetof(CompactVertex, position)},
+                     {3, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(CompactVertex, color)}}};
+        case VertexFormat::Snorm16:
+            return {{{3, GL_SHORT, GL_TRUE, offsetof(CompactVertex, position)},
+                     {3, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(CompactVertex, color)}}};
+        default:
+            return {{{3, GL_FLOAT, GL_FALSE, offsetof(FloatVertex, position)},
+                     {3, GL_FLOAT, GL_FALSE, offsetof(FloatVertex, color)}}};
+    }
+}
+
+bool App::Mesh::ParseVertexFormat(std::string_view name, VertexFormat &format)
+{
+    for (VertexFormat const candidate : {VertexFormat::Float, VertexFormat::Half,
+                                         VertexFormat::Snorm16})
+    {
+        if (name == ToString(candidate))
+        {
+            format = candidate;
+            return true;
+        }
+    }
+
+    std::cerr << "Unknown vertex format \"" << name << "\" (float, half or snorm16)" << std::endl;
+    return false;
+}
+
+char const *App::Mesh::ToString(VertexFormat format)
+{
+    switch (format)
+    {
+        case VertexFormat::Half:
+            return "half";
+        case VertexFormat::Snorm16:
+            return "snorm16";
+        default:
+            return "float";
+    }
+}
+
+App::Mesh::PackedVertices App::Mesh::Pack(Mesh const &mesh, VertexFormat format)
+{
+    TRACE_SCOPE("Mesh::Pack");
+
+    PackedVertices packed;
+    packed.format = format;
+    packed.data.resize(mesh.vertices.size() * VertexSize(format));
+    if (format == VertexFormat::Float)
+    {
+        for (std::size_t i = 0; i < mesh.vertices.size(); ++i)
+        {
+            FloatVertex const vertex{mesh.vertices[i].position, mesh.vertices[i].color};
+            std::memcpy(&packed.data[i * sizeof(FloatVertex)], &vertex, sizeof(vertex));
+        }
+        return packed;
+    }
+
+    // Map the bounds to [-1, 1] on every axis, where both snorm16 and halfs are the most precise
+    for (std::size_t c = 0; c < 3; ++c)
+    {
+        GLfloat const halfExtent = (mesh.boundsMax[c] - mesh.boundsMin[c]) / 2.0F;
+        packed.transform.scale[c] = halfExtent > 0.0F ? halfExtent : 1.0F;
+        packed.transform.offset[c] = (mesh.boundsMin[c] + mesh.boundsMax[c]) / 2.0F;
+    }
+
+    for (std::size_t i = 0; i < mesh.vertices.size(); ++i)
+    {
+        Vertex const &vertex = mesh.vertices[i];
+        CompactVertex compact{};
+        for (std::size_t c = 0; c < 3; ++c)
+        {
+            GLfloat const position =
+                (vertex.position[c] - packed.transform.offset[c]) / packed.transform.scale[c];
+            compact.position[c] = format == VertexFormat::Half
+                                      ? ToHalf(position)
+                                      : static_cast<std::uint16_t>(ToSnorm16(position));
+            compact.color[c] = ToUnorm8(vertex.color[c]);
+        }
+        compact.color[3] = 255;
+        std::memcpy(&packed.data[i * sizeof(CompactVertex)], &compact, sizeof(compact));
+    }
+    return packed;
+}
+
+std::size_t App::Mesh::IndexSize(GLenum type)
+{
+    return type == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(GLuint);
+}
+
+App::Mesh::PackedIndices App::Mesh::PackIndices(Mesh const &mesh)
+{
+    // Primitive restart is not used, so 0xFFFF is an index like any other
+    PackedIndices packed;
+    packed.type = mesh.vertices.size() <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    packed.data.resize(mesh.indices.size() * IndexSize(packed.type));
+    if (packed.type == GL_UNSIGNED_INT)
+    {
+        std::memcpy(packed.data.data(), mesh.indices.data(), packed.data.size());
+        return packed;
+    }
+
+    for (std::size_t i = 0; i < mesh.indices.size(); ++i)
+    {
+        auto const index = static_cast<std::uint16_t>(mesh.indices[i]);
+        std::memcpy(&packed.data[i * sizeof(index)], &index, sizeof(index));
+    }
+    return packed;
+}
+
+bool App::Mesh::Load(std::filesystem::path const &path, Mesh &mesh, unsigned threads)
+{
+    TRACE_SCOPE("Mesh::Load");
+
+    mesh = Mesh{};
+
+    std::string contents;
+    if (!ReadFile(path, contents))
+    {
+        std::cerr << "Could not read mesh " << path << std::endl;
+        return false;
+    }
+
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    bool loaded = false;
+    if (extension == ".obj")
+    {
+        loaded = LoadObj(contents, mesh, ThreadCount(threads));
+    }
+    else if (extension == ".glb")
+    {
+        loaded = LoadGlb(contents, mesh, ThreadCount(threads));
+    }
+    else
+    {
+        std::cerr << "Unsupported mesh format " << path << " (.obj or .glb)" << std::endl;
+    }
+
+    if (!loaded || mesh.indices.empty())
+    {
+        std::cerr << "Could not load mesh " << path << std::endl;
+        mesh = Mesh{};
+        return false;
+    }
+
+    ComputeBounds(mesh);
+    return true;
+}
+
+void App::Mesh::Deduplicate(Mesh &mesh)
+{
+    TRACE_SCOPE("Mesh::Deduplicate");
+
+    std::vector<Vertex> vertices;
+    VertexTable table(mesh.vertices.size());
+    std::vector<GLuint> remap(mesh.vertices.size());
+    for (std::size_t i = 0; i < mesh.vertices.size(); ++i)
+    {
+        remap[i] = table.Insert(mesh.vertices[i], vertices);
+    }
+
+    for (GLuint &index : mesh.indices)
+    {
+        index = remap[index];
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+void App::Mesh::ComputeBounds(Mesh &mesh)
+{
+    constexpr GLfloat infinity = std::numeric_limits<GLfloat>::infinity();
+    mesh.boundsMin = {infinity, infinity, infinity};
+    mesh.boundsMax = {-infinity, -infinity, -infinity};
+
+    for (Vertex const &vertex : mesh.vertices)
+    {
+        for (std::size_t c = 0; c < 3; ++c)
+        {
+            mesh.boundsMin[c] = std::min(mesh.boundsMin[c], vertex.position[c]);
+            mesh.boundsMax[c] = std::max(mesh.boundsMax[c], vertex.position[c]);
+        }
+    }
+}
@@ -0,0 +1,238 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "App/Hash.h"
+#include "App/MeshCache.h"
+#include "App/Trace.h"
+
+namespace {
+
+constexpr std::uint32_t fileMagic = 0x4853454D; // "MESH"
+constexpr std::uint32_t fileVersion = 4;
+
+/// Header of a baked mesh file, followed by the vertex and index sections at the given (page
+/// aligned) offsets
+struct FileHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t key;        // Source path, size and modification time
+    std::uint32_t format;     // Mesh::VertexFormat
+    std::uint32_t vertexSize; // Guards against a change of the vertex layout
+    std::uint32_t indexType;  // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    std::uint32_t indexSize;
+    std::uint64_t vertexCount;
+    std::uint64_t vertexOffset;
+    std::uint64_t indexCount;
+    std::uint64_t indexOffset;
+    App::Mesh::PositionTransform transform;
+};
+
+unsigned long hits = 0;   // NOLINT
+unsigned long misses = 0; // NOLINT
+
+/// Key of the current contents of a mesh file (0 if it cannot be read)
+std::uint64_t KeyOf(std::filesystem::path const &source)
+{
+    std::error_code error;
+    std::filesystem::path const absolute = std::filesystem::absolute(source, error);
+    auto const size = std::filesystem::file_size(source, error);
+    auto const time = std::filesystem::last_write_time(source, error);
+    if (error)
+    {
+        return 0;
+    }
+
+    std::uint64_t hash = App::Fnv1a64(absolute.string());
+    hash = App::Fnv1a64("\n", hash);
+    hash = App::Fnv1a64(std::to_string(size), hash);
+    hash = App::Fnv1a64("\n", hash);
+    return App::Fnv1a64(std::to_string(time.time_since_epoch().count()), hash);
+}
+
+/// One baked file per source path (a newer version of the source replaces it)
+std::filesystem::path PathOf(std::filesystem::path const &source)
+{
+    std::error_code error;
+    std::uint64_t const name = App::Fnv1a64(std::filesystem::absolute(source, error).string());
+
+    std::array<char, 17> text{};
+    std::snprintf(text.data(), text.size(), "%016llx", static_cast<unsigned long long>(name));
+    return std::filesystem::path{App::MeshCache::directory} / (std::string{text.data()} + ".mesh");
+}
+
+std::uint64_t AlignUp(std::uint64_t offset, std::uint64_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+namespace App::MeshCache {
+
+bool enabled = true;                     // NOLINT
+std::string directory = ".cache/meshes"; // NOLINT
+
+} // namespace App::MeshCache
+
+bool App::MeshCache::Open(std::filesystem::path const &source, Mesh::VertexFormat format,
+                          Mapping &mapping)
+{
+    TRACE_SCOPE("MeshCache::Open");
+
+    mapping = Mapping{};
+    std::uint64_t const key = KeyOf(source);
+    if (!enabled || key == 0)
+    {
+        return false;
+    }
+
+    std::filesystem::path const path = PathOf(source);
+    int const file = open(path.c_str(), O_RDONLY); // NOLINT
+    if (file < 0)
+    {
+        ++misses;
+        return false;
+    }
+
+    std::error_code error;
+    std::size_t const length = std::filesystem::file_size(path, error);
+    void *address = error || length < sizeof(FileHeader)
+                        ? MAP_FAILED
+                        : mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file); // The mapping keeps the file alive
+    if (address == MAP_FAILED)
+    {
+        ++misses;
+        return false;
+    }
+
+    FileHeader header{};
+    std::memcpy(&header, address, sizeof(header));
+
+    auto const fits = [&](std::uint64_t offset, std::uint64_t count, std::uint64_t size) {
+        return offset >= sizeof(FileHeader) && offset <= length &&
+               count <= (length - offset) / size;
+    };
+    auto const pageSize = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+    std::size_t const vertexSize = Mesh::VertexSize(format);
+    std::size_t const indexSize = Mesh::IndexSize(header.indexType);
+    if (header.magic != fileMagic || header.version != fileVersion || header.key != key ||
+        header.format != static_cast<std::uint32_t>(format) || header.vertexSize != vertexSize ||
+        (header.indexType != GL_UNSIGNED_SHORT && header.indexType != GL_UNSIGNED_INT) ||
+        header.indexSize != indexSize || header.vertexOffset % pageSize != 0 ||
+        header.indexOffset % pageSize != 0 ||
+        !fits(header.vertexOffset, header.vertexCount, vertexSize) ||
+        !fits(header.indexOffset, header.indexCount, indexSize))
+    {
+        // Stale (the source changed), another vertex format or another version of the file format:
+        // it is baked again after loading
+        munmap(address, length);
+        ++misses;
+        return false;
+    }
+
+    // Both sections are read once by the upload: start reading ahead now
+    posix_madvise(address, length, POSIX_MADV_WILLNEED);
+
+    auto const *bytes = static_cast<unsigned char const *>(address);
+    auto const *vertices = bytes + header.vertexOffset; // NOLINT
+    auto const *indices = bytes + header.indexOffset;   // NOLINT
+    mapping.format = format;
+    mapping.vertices = {reinterpret_cast<std::byte const *>(vertices), // NOLINT
+                        header.vertexCount * vertexSize};
+    mapping.transform = header.transform;
+    mapping.indexType = header.indexType;
+    mapping.indices = {reinterpret_cast<std::byte const *>(indices), // NOLINT
+                       header.indexCount * indexSize};
+    mapping.address = address;
+    mapping.length = length;
+
+    ++hits;
+    return true;
+}
+
+void App::MeshCache::Close(Mapping &mapping)
+{
+    if (mapping.address != nullptr)
+    {
+        munmap(mapping.address, mapping.length);
+    }
+    mapping = Mapping{};
+}
+
+void App::MeshCache::Store(std::filesystem::path const &source,
+                           Mesh::PackedVertices const &vertices, Mesh::PackedIndices const &indices)
+{
+    TRACE_SCOPE("MeshCache::Store");
+
+    std::uint64_t const key = KeyOf(source);
+    if (!enabled || key == 0)
+    {
+        return;
+    }
+
+    // The sections start on page boundaries, so that they can be mapped (and read ahead) on their
+    // own; the offsets are in the header, so a file baked on a system with smaller pages is still
+    // valid if they are multiples of the page size of the system reading it
+    auto const pageSize = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+    std::size_t const vertexSize = Mesh::VertexSize(vertices.format);
+    FileHeader header{fileMagic,
+                      fileVersion,
+                      key,
+                      static_cast<std::uint32_t>(vertices.format),
+                      static_cast<std::uint32_t>(vertexSize),
+                      indices.type,
+                      static_cast<std::uint32_t>(Mesh::IndexSize(indices.type)),
+                      vertices.data.size() / vertexSize,
+                      AlignUp(sizeof(FileHeader), pageSize),
+                      indices.data.size() / Mesh::IndexSize(indices.type),
+                      0,
+                      vertices.transform};
+    header.indexOffset = AlignUp(header.vertexOffset + vertices.data.size(), pageSize);
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    // Write to a temporary file first, so that an interrupted write never leaves a truncated mesh
+    // under the final name
+    std::filesystem::path const path = PathOf(source);
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        std::vector<char> const padding(pageSize, 0);
+        auto const pad = [&](std::uint64_t offset) {
+            auto const position = static_cast<std::uint64_t>(file.tellp());
+            file.write(padding.data(), static_cast<std::streamsize>(offset - position));
+        };
+
+        file.write(reinterpret_cast<char const *>(&header), sizeof(header)); // NOLINT
+        pad(header.vertexOffset);
+        file.write(reinterpret_cast<char const *>(vertices.data.data()), // NOLINT
+                   static_cast<std::streamsize>(vertices.data.size()));
+        pad(header.indexOffset);
+        file.write(reinterpret_cast<char const *>(indices.data.data()), // NOLINT
+                   static_cast<std::streamsize>(indices.data.size()));
+        if (!file)
+        {
+            std::cerr << "Could not write mesh cache file " << temporary << std::endl;
+            return;
+        }
+    }
+    std::filesystem::rename(temporary, path, error);
+}
+
+void App::MeshCache::Dump(std::ostream &out)
+{
+    out << "Mesh cache: " << hits << " hits, " << misses << " misses\n";
+}
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "App/MeshOptimizer.h"
+#include "App/Trace.h"
+
+namespace {
+
+using App::Mesh::Mesh;
+using App::MeshOptimizer::cacheSize;
+
+using Vec3 = std::array<double, 3>;
+
+constexpr GLuint none = std::numeric_limits<GLuint>::max();
+
+/// Triangles of a contiguous run of the output of Tipsify: [first, last) in triangles
+struct Cluster
+{
+    std::size_t first;
+    std::size_t last;
+    double sortKey;
+};
+
+/// Tipsify: reorder the triangles of `indices` for a vertex cache of `cacheSize` entries
+///
+/// @param clusterStarts the first triangle of each cluster of the new order
+/// @return std::vector<GLuint> the reordered indices
+std::vector<GLuint> Tipsify(std::vector<GLuint> const &indices, std::size_t vertexCount,
+                            std::vector<std::size_t> &clusterStarts)
+{
+    std::size_t const triangleCount = indices.size() / 3;
+
+    // Triangles of each vertex (compressed rows), and the number not emitted yet
+    std::vector<std::size_t> offsets(vertexCount + 1, 0);
+    for (GLuint const index : indices)
+    {
+        ++offsets[index + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<GLuint> live(vertexCount, 0);
+    std::vector<std::size_t> adjacency(indices.size());
+    for (std::size_t i = 0; i < indices.size(); ++i)
+    {
+        GLuint const vertex = indices[i];
+        adjacency[offsets[vertex] + live[vertex]++] = i / 3;
+    }
+
+    std::vector<std::size_t> timestamps(vertexCount, 0); // When the vertex entered the cache
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<GLuint> deadEnds; // Recently used vertices, to restart from
+    std::vector<GLuint> candidates;
+    std::vector<GLuint> output;
+    output.reserve(indices.size());
+
+    std::size_t time = cacheSize + 1;
+    GLuint cursor = 0;
+    GLuint fan = 0;
+    bool jumped = true;
+    while (fan != none)
+    {
+        // Emit the remaining triangles around the fanning vertex
+        candidates.clear();
+        for (std::size_t a = offsets[fan]; a < offsets[fan + 1]; ++a)
+        {
+            std::size_t const triangle = adjacency[a];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+            if (jumped)
+            {
+                clusterStarts.push_back(output.size() / 3);
+                jumped = false;
+            }
+
+            for (std::size_t corner = 0; corner < 3; ++corner)
+            {
+                GLuint const vertex = indices[(triangle * 3) + corner];
+                output.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                --live[vertex];
+                if (time - timestamps[vertex] > cacheSize)
+                {
+                    timestamps[vertex] = time++;
+                }
+            }
+            emitted[triangle] = true;
+        }
+
+        // Next: the candidate that stays in the cache the longest while its own triangles are
+        // emitted (each adds at most two vertices to the cache)
+        fan = none;
+        std::size_t best = 0;
+        for (GLuint const vertex : candidates)
+        {
+            if (live[vertex] == 0)
+            {
+                continue;
+            }
+            std::size_t const age = time - timestamps[vertex];
+            if (age + (2 * std::size_t{live[vertex]}) <= cacheSize && age > best)
+            {
+                best = age;
+                fan = vertex;
+            }
+        }
+        if (fan != none)
+        {
+            continue;
+        }
+
+        // Dead end: a recently used vertex, or else the next vertex with triangles left
+        jumped = true;
+        while (!deadEnds.empty() && fan == none)
+        {
+            GLuint const vertex = deadEnds.back();
+            deadEnds.pop_back();
+            fan = live[vertex] > 0 ? vertex : none;
+        }
+        while (fan == none && cursor < vertexCount)
+        {
+            fan = live[cursor] > 0 ? cursor : none;
+            ++cursor;
+        }
+    }
+
+    return output;
+}
+
+Vec3 Position(Mesh const &mesh, GLuint index)
+{
+    auto const &position = mesh.vertices[index].position;
+    return {position[0], position[1], position[2]};
+}
+
+/// Sort the clusters of triangles so that the ones facing away from the center of the mesh (the
+/// ones most likely in front) are drawn first
+void OptimizeOverdraw(Mesh &mesh, std::vector<std::size_t> const &clusterStarts)
+{
+    std::size_t const triangleCount = mesh.indices.size() / 3;
+
+    Vec3 meshCenter{};
+    for (GLuint const index : mesh.indices)
+    {
+        Vec3 const position = Position(mesh, index);
+        for (std::size_t c = 0; c < 3; ++c)
+        {
+            meshCenter[c] += position[c] / static_cast<double>(mesh.indices.size());
+        }
+    }
+
+    std::vector<Cluster> clusters;
+    for (std::size_t i = 0; i < clusterStarts.size(); ++i)
+    {
+        Cluster cluster{clusterStarts[i],
+                        i + 1 < clusterStarts.size() ? clusterStarts[i + 1] : triangleCount, 0.0};
+
+        // Area weighted normal and centroid of the cluster
+        Vec3 normal{};
+        Vec3 center{};
+        for (std::size_t t = cluster.first; t < cluster.last; ++t)
+        {
+            Vec3 const a = Position(mesh, mesh.indices[t * 3]);
+            Vec3 const b = Position(mesh, mesh.indices[(t * 3) + 1]);
+            Vec3 const c = Position(mesh, mesh.indices[(t * 3) + 2]);
+            Vec3 const ab{b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            Vec3 const ac{c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+            normal[0] += (ab[1] * ac[2]) - (ab[2] * ac[1]);
+            normal[1] += (ab[2] * ac[0]) - (ab[0] * ac[2]);
+            normal[2] += (ab[0] * ac[1]) - (ab[1] * ac[0]);
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                center[k] += (a[k] + b[k] + c[k]) / 3.0;
+            }
+        }
+
+        double const length = std::hypot(normal[0], normal[1], normal[2]);
+        auto const count = static_cast<double>(cluster.last - cluster.first);
+        for (std::size_t k = 0; k < 3 && length > 0.0; ++k)
+        {
+            cluster.sortKey += (center[k] / count - meshCenter[k]) * normal[k] / length;
+        }
+        clusters.push_back(cluster);
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](Cluster const &a, Cluster const &b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<GLuint> indices;
+    indices.reserve(mesh.indices.size());
+    for (Cluster const &cluster : clusters)
+    {
+        indices.insert(indices.end(), mesh.indices.begin() + static_cast<long>(cluster.first * 3),
+                       mesh.indices.begin() + static_cast<long>(cluster.last * 3));
+    }
+    mesh.indices = std::move(indices);
+}
+
+/// Renumber the vertices in the order of their first use (unused vertices are dropped)
+void OptimizeVertexFetch(Mesh &mesh)
+{
+    std::vector<GLuint> remap(mesh.vertices.size(), none);
+    std::vector<App::Mesh::Vertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+
+    for (GLuint &index : mesh.indices)
+    {
+        if (remap[index] == none)
+        {
+            remap[index] = static_cast<GLuint>(vertices.size());
+            vertices.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+} // namespace
+
+App::MeshOptimizer::Statistics App::MeshOptimizer::Analyze(std::span<GLuint const> indices,
+                                                           std::size_t vertexCount)
+{
+    // A FIFO cache: a vertex is a hit while fewer than `cacheSize` misses happened since its own
+    std::vector<std::size_t> missTimes(vertexCount, 0);
+    std::vector<bool> used(vertexCount, false);
+    std::size_t misses = 0;
+    std::size_t usedCount = 0;
+    for (GLuint const index : indices)
+    {
+        if (!used[index] || misses - missTimes[index] >= cacheSize)
+        {
+            usedCount += used[index] ? 0 : 1;
+            used[index] = true;
+            missTimes[index] = misses++;
+        }
+    }
+
+    auto const triangles = static_cast<double>(indices.size() / 3);
+    return {triangles > 0 ? static_cast<double>(misses) / triangles : 0.0,
+            usedCount > 0 ? static_cast<double>(misses) / static_cast<double>(usedCount) : 0.0};
+}
+
+void App::MeshOptimizer::Optimize(Mesh::Mesh &mesh)
+{
+    TRACE_SCOPE("MeshOptimizer::Optimize");
+
+    if (mesh.indices.empty())
+    {
+        return;
+    }
+
+    std::vector<std::size_t> clusterStarts;
+    mesh.indices = Tipsify(mesh.indices, mesh.vertices.size(), clusterStarts);
+    OptimizeOverdraw(mesh, clusterStarts);
+    OptimizeVertexFetch(mesh);
+}
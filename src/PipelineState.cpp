@@ -0,0 +1,195 @@
+#include <cstddef>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "App/Hash.h"
+#include "App/PipelineState.h"
+#include "App/StateCache.h"
+
+namespace {
+
+using App::PipelineState::Description;
+using App::PipelineState::Id;
+
+constexpr unsigned fieldBits = 16;
+constexpr std::size_t maxFieldValue = (std::size_t{1} << fieldBits) - 1;
+
+// Bit offsets of the fields of an id
+constexpr unsigned programShift = 3 * fieldBits;
+constexpr unsigned vertexArrayShift = 2 * fieldBits;
+constexpr unsigned fixedFunctionShift = fieldBits;
+
+/// The fixed-function part of a description (one field of the id)
+struct FixedFunction
+{
+    bool depthTest;
+    GLenum depthFunc;
+    bool depthWrite;
+    bool cullFace;
+    GLenum cullMode;
+    GLenum frontFace;
+    bool blend;
+    GLenum blendSource;
+    GLenum blendDestination;
+    std::array<GLint, 4> viewport;
+
+    bool operator==(FixedFunction const &) const = default;
+};
+
+FixedFunction FixedFunctionOf(Description const &d)
+{
+    return {d.depthTest, d.depthFunc, d.depthWrite,  d.cullFace,         d.cullMode,
+            d.frontFace, d.blend,     d.blendSource, d.blendDestination, d.viewport};
+}
+
+/// FNV-1a over the fields of a description (not its bytes: the padding is indeterminate)
+struct DescriptionHash
+{
+    std::size_t operator()(Description const &d) const
+    {
+        std::uint64_t hash = App::fnv1aOffsetBasis;
+        for (std::uint32_t const value :
+             {d.program, d.programPipeline, d.vertexArray, std::uint32_t{d.depthTest},
+              d.depthFunc, std::uint32_t{d.depthWrite}, std::uint32_t{d.cullFace}, d.cullMode,
+              d.frontFace, std::uint32_t{d.blend}, d.blendSource, d.blendDestination,
+              static_cast<std::uint32_t>(d.viewport[0]), static_cast<std::uint32_t>(d.viewport[1]),
+              static_cast<std::uint32_t>(d.viewport[2]), static_cast<std::uint32_t>(d.viewport[3])})
+        {
+            hash = (hash ^ value) * App::fnv1aPrime;
+        }
+        return static_cast<std::size_t>(hash);
+    }
+};
+
+std::vector<Description> states;                           // By state field - 1 -- NOLINT
+std::unordered_map<Description, Id, DescriptionHash> ids;  // NOLINT
+std::vector<std::uint64_t> programs;                       // Program and pipeline -- NOLINT
+std::vector<GLuint> vertexArrays;                          // NOLINT
+std::vector<FixedFunction> fixedFunctions;                 // NOLINT
+
+Id current = App::PipelineState::invalidId; // NOLINT
+unsigned long long applied = 0;             // NOLINT
+unsigned long long elided = 0;              // NOLINT
+
+/// The number (from 1) of a value among the distinct values of a field, added if new
+///
+/// @return std::size_t the number, 0 if the field has no room left
+template <typename T>
+std::size_t FieldValue(std::vector<T> &values, T const &value)
+{
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        if (values[i] == value)
+        {
+            return i + 1;
+        }
+    }
+
+    if (values.size() == maxFieldValue)
+    {
+        return 0;
+    }
+
+    values.push_back(value);
+    return values.size();
+}
+
+void SetCapability(GLenum capability, bool enabled)
+{
+    if (enabled)
+    {
+        App::StateCache::Enable(capability);
+    }
+    else
+    {
+        App::StateCache::Disable(capability);
+    }
+}
+
+} // namespace
+
+App::PipelineState::Id App::PipelineState::Create(Description const &description)
+{
+    if (auto const found = ids.find(description); found != ids.end())
+    {
+        return found->second;
+    }
+
+    std::size_t const program = FieldValue(
+        programs, std::uint64_t{description.program} |
+                      (std::uint64_t{description.programPipeline} << 32U));
+    std::size_t const vertexArray = FieldValue(vertexArrays, description.vertexArray);
+    std::size_t const fixedFunction = FieldValue(fixedFunctions, FixedFunctionOf(description));
+    if (program == 0 || vertexArray == 0 || fixedFunction == 0 || states.size() == maxFieldValue)
+    {
+        std::cerr << "Too many distinct pipeline states" << std::endl;
+        return invalidId;
+    }
+
+    states.push_back(description);
+    Id const id = (Id{program} << programShift) | (Id{vertexArray} << vertexArrayShift) |
+                  (Id{fixedFunction} << fixedFunctionShift) | Id{states.size()};
+    ids.emplace(description, id);
+    return id;
+}
+
+App::PipelineState::Description const &App::PipelineState::Get(Id id)
+{
+    return states[(id & maxFieldValue) - 1];
+}
+
+void App::PipelineState::Apply(Id id)
+{
+    if (id == current)
+    {
+        ++elided;
+        return;
+    }
+
+    ++applied;
+    current = id;
+    Description const &d = Get(id);
+
+    // A program pipeline is only used while no program is current
+    App::StateCache::UseProgram(d.program);
+    if (d.program == 0)
+    {
+        App::StateCache::BindProgramPipeline(d.programPipeline);
+    }
+
+    App::StateCache::BindVertexArray(d.vertexArray);
+
+    SetCapability(GL_DEPTH_TEST, d.depthTest);
+    if (d.depthTest)
+    {
+        App::StateCache::DepthFunc(d.depthFunc);
+    }
+    App::StateCache::DepthMask(d.depthWrite ? GL_TRUE : GL_FALSE);
+
+    SetCapability(GL_CULL_FACE, d.cullFace);
+    if (d.cullFace)
+    {
+        App::StateCache::CullFace(d.cullMode);
+        App::StateCache::FrontFace(d.frontFace);
+    }
+
+    SetCapability(GL_BLEND, d.blend);
+    if (d.blend)
+    {
+        App::StateCache::BlendFunc(d.blendSource, d.blendDestination);
+    }
+
+    App::StateCache::Viewport(d.viewport[0], d.viewport[1], d.viewport[2], d.viewport[3]);
+}
+
+void App::PipelineState::Invalidate()
+{
+    current = invalidId;
+}
+
+void App::PipelineState::Dump(std::ostream &out)
+{
+    out << "Pipeline states: " << states.size() << " created, " << applied << " applied, "
+        << elided << " elided\n";
+}
@@ -0,0 +1,185 @@
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <vector>
+
+#include "App/GLRecorder.h"
+#include "App/Hash.h"
+#include "App/ProgramCache.h"
+#include "App/Trace.h"
+
+namespace {
+
+constexpr std::uint32_t fileMagic = 0x42504C47; // "GLPB"
+constexpr std::uint32_t fileVersion = 1;
+
+/// Header of a cached program binary file
+struct FileHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t key; // Guards against renamed/mixed up files
+    std::uint32_t format;
+    std::uint32_t length;
+};
+
+unsigned long hits = 0;   // NOLINT
+unsigned long misses = 0; // NOLINT
+
+std::filesystem::path PathOf(std::uint64_t key)
+{
+    std::array<char, 17> name{};
+    std::snprintf(name.data(), name.size(), "%016llx", static_cast<unsigned long long>(key));
+    return std::filesystem::path{App::ProgramCache::directory} /
+           (std::string{name.data()} + ".bin");
+}
+
+/// Whether the driver can give us program binaries at all
+bool Supported()
+{
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+} // namespace
+
+namespace App::ProgramCache {
+
+bool enabled = true;                       // NOLINT
+std::string directory = ".cache/programs"; // NOLINT
+
+} // namespace App::ProgramCache
+
+std::uint64_t App::ProgramCache::Key(std::string_view vertexShaderSource,
+                                     std::string_view fragmentShaderSource)
+{
+    auto const glString = [](GLenum name) {
+        return std::string_view{reinterpret_cast<char const *>(glGetString(name))}; // NOLINT
+    };
+
+    // Separators keep ("ab", "c") and ("a", "bc") apart
+    std::uint64_t hash = Fnv1a64(glString(GL_RENDERER));
+    hash = Fnv1a64("\n", hash);
+    hash = Fnv1a64(glString(GL_VERSION), hash);
+    hash = Fnv1a64("\n", hash);
+    hash = Fnv1a64(vertexShaderSource, hash);
+    hash = Fnv1a64(std::string_view{"\0", 1}, hash);
+    return Fnv1a64(fragmentShaderSource, hash);
+}
+
+GLuint App::ProgramCache::Load(std::uint64_t key, bool separable)
+{
+    TRACE_SCOPE("ProgramCache::Load");
+
+    // A capture must contain the shader sources to be replayable (on another driver too), so while
+    // recording programs are always compiled
+    if (!enabled || App::GLRecorder::IsRecording() || !Supported())
+    {
+        return 0;
+    }
+
+    std::filesystem::path const path = PathOf(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        ++misses;
+        return 0;
+    }
+
+    // Check the header before trusting its length: a corrupt or foreign file is only a miss
+    std::error_code error;
+    std::uintmax_t const fileSize = std::filesystem::file_size(path, error);
+    FileHeader header{};
+    file.read(reinterpret_cast<char *>(&header), sizeof(header)); // NOLINT
+    bool valid = file && !error && header.magic == fileMagic && header.version == fileVersion &&
+                 header.key == key && header.length == fileSize - sizeof(header);
+
+    std::vector<char> binary(valid ? header.length : 0);
+    if (valid)
+    {
+        file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+        valid = static_cast<bool>(file);
+    }
+
+    if (!valid)
+    {
+        std::cerr << "Ignoring invalid program cache file " << path << std::endl;
+        ++misses;
+        return 0;
+    }
+
+    GLuint const program = glCreateProgram();
+    if (separable)
+    {
+        glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    }
+    glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    // The driver may reject a binary it produced itself (e.g. after an update that did not change
+    // GL_VERSION): drop the file, it will be stored again after compiling from source
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_FALSE)
+    {
+        glDeleteProgram(program);
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+        ++misses;
+        return 0;
+    }
+
+    ++hits;
+    return program;
+}
+
+void App::ProgramCache::Store(std::uint64_t key, GLuint program)
+{
+    TRACE_SCOPE("ProgramCache::Store");
+
+    if (!enabled || program == 0 || !Supported())
+    {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return;
+    }
+
+    std::vector<char> binary(static_cast<std::size_t>(length));
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    // Write to a temporary file first, so that an interrupted write never leaves a truncated binary
+    // under the final name
+    std::filesystem::path const path = PathOf(key);
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        FileHeader const header{fileMagic, fileVersion, key, format,
+                                static_cast<std::uint32_t>(length)};
+        file.write(reinterpret_cast<char const *>(&header), sizeof(header)); // NOLINT
+        file.write(binary.data(), length);
+        if (!file)
+        {
+            std::cerr << "Could not write program cache file " << temporary << std::endl;
+            return;
+        }
+    }
+    std::filesystem::rename(temporary, path, error);
+}
+
+void App::ProgramCache::Dump(std::ostream &out)
+{
+    out << "Program cache: " << hits << " hits, " << misses << " misses\n";
+}
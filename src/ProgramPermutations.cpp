@@ -0,0 +1,473 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <set>
+#include <unordered_map>
+
+#include "App/ProgramCache.h"
+#include "App/ProgramPermutations.h"
+#include "App/ProgramReflection.h"
+#include "App/Shader.h"
+#include "App/ShaderSource.h"
+#include "App/Trace.h"
+
+namespace {
+
+using App::ProgramPermutations::Key;
+
+constexpr std::array<char const *, App::ProgramPermutations::FeatureCount> featureNames = {
+    "VERTEX_COLOR",
+    "INSTANCING",
+    "FOG",
+};
+
+/// A program in memory, with its place in the use order
+struct Resident
+{
+    GLuint program;
+    std::list<Key>::iterator use;
+};
+
+std::unordered_map<Key, Resident> programs; // NOLINT
+std::list<Key> useOrder;                    // Most recently used first -- NOLINT
+std::set<Key> requested;                    // Permutations asked for during this run -- NOLINT
+
+// Separable mode
+std::unordered_map<std::uint64_t, GLuint> stagePrograms; // By `StageKey` -- NOLINT
+std::unordered_map<Key, App::ProgramPermutations::Pipeline> pipelines; // NOLINT
+
+unsigned long hits = 0;      // NOLINT
+unsigned long misses = 0;    // NOLINT
+unsigned long prewarmed = 0; // NOLINT
+unsigned long evictions = 0; // NOLINT
+
+void DeleteProgram(GLuint program)
+{
+    App::ProgramReflection::Forget(program);
+    glDeleteProgram(program);
+}
+
+/// Add a built program as the most recently used one, evicting the least recently used ones past
+/// the budget
+void Add(Key key, GLuint program)
+{
+    App::ProgramReflection::Reflect(program);
+    useOrder.push_front(key);
+    programs[key] = Resident{program, useOrder.begin()};
+
+    // Never evict the program just added
+    while (programs.size() > std::max<std::size_t>(App::ProgramPermutations::budget, 1))
+    {
+        Key const evicted = useOrder.back();
+        useOrder.pop_back();
+        DeleteProgram(programs.at(evicted).program);
+        programs.erase(evicted);
+        ++evictions;
+    }
+}
+
+/// The features of a permutation that affect a stage
+Key StageFeatures(GLenum stage, Key key)
+{
+    return key & (stage == GL_VERTEX_SHADER ? App::ProgramPermutations::vertexFeatures
+                                            : App::ProgramPermutations::fragmentFeatures);
+}
+
+/// Key of a stage program: the stage and the features of that stage
+std::uint64_t StageKey(GLenum stage, Key key)
+{
+    return (std::uint64_t{stage} << 32U) | StageFeatures(stage, key);
+}
+
+/// A stage program being built: from the binary cache (`program`) or the compiler (`pending`)
+struct StageBuild
+{
+    GLenum stage;
+    std::uint64_t cacheKey;
+    GLuint program;
+    App::Shader::PendingProgram pending;
+};
+
+/// Start building the program of one stage of a permutation
+StageBuild SubmitStage(GLenum stage, Key key)
+{
+    std::string const source = App::ProgramPermutations::LoadStageSource(stage, key);
+
+    // One cache entry per stage: the source goes on the side of its stage
+    bool const vertex = stage == GL_VERTEX_SHADER;
+    std::uint64_t const cacheKey = vertex ? App::ProgramCache::Key(source, "")
+                                          : App::ProgramCache::Key("", source);
+
+    StageBuild build{stage, cacheKey, App::ProgramCache::Load(cacheKey, true), {}};
+    if (build.program == 0)
+    {
+        build.pending = App::Shader::SubmitStage(stage, source);
+    }
+
+    return build;
+}
+
+/// Finish building the program of a stage
+///
+/// @return GLuint the program, 0 on failure
+GLuint FinishStage(StageBuild &build)
+{
+    if (build.program == 0)
+    {
+        build.program = App::Shader::Finish(build.pending);
+        App::ProgramCache::Store(build.cacheKey, build.program);
+    }
+    if (build.program != 0)
+    {
+        App::ProgramReflection::Reflect(build.program);
+    }
+
+    return build.program;
+}
+
+/// Create the pipeline object combining two stage programs
+App::ProgramPermutations::Pipeline CreatePipeline(GLuint vertexProgram, GLuint fragmentProgram)
+{
+    App::ProgramPermutations::Pipeline pipeline{0, vertexProgram, fragmentProgram};
+    glGenProgramPipelines(1, &pipeline.pipeline);
+    glUseProgramStages(pipeline.pipeline, GL_VERTEX_SHADER_BIT, vertexProgram);
+    glUseProgramStages(pipeline.pipeline, GL_FRAGMENT_SHADER_BIT, fragmentProgram);
+    return pipeline;
+}
+
+} // namespace
+
+namespace App::ProgramPermutations {
+
+std::size_t budget = 32; // NOLINT
+bool separable = false;  // NOLINT
+
+} // namespace App::ProgramPermutations
+
+bool App::ProgramPermutations::ParseFeatures(std::string const &names, Key &key)
+{
+    key = 0;
+
+    std::string name;
+    for (std::size_t i = 0; i <= names.size(); ++i)
+    {
+        char const c = i < names.size() ? names[i] : ',';
+        if (c != ',' && std::isspace(static_cast<unsigned char>(c)) == 0)
+        {
+            name += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            continue;
+        }
+        if (name.empty() || name == "NONE")
+        {
+            name.clear();
+            continue;
+        }
+
+        auto const found = std::find(featureNames.begin(), featureNames.end(), name);
+        if (found == featureNames.end())
+        {
+            std::cerr << "Unknown shader feature: " << name << std::endl;
+            return false;
+        }
+        key |= 1U << static_cast<unsigned>(found - featureNames.begin());
+        name.clear();
+    }
+
+    return true;
+}
+
+std::vector<std::string> App::ProgramPermutations::Defines(Key key)
+{
+    std::vector<std::string> defines;
+    for (std::size_t i = 0; i < featureNames.size(); ++i)
+    {
+        if ((key & (1U << i)) != 0)
+        {
+            defines.push_back(std::string{"USE_"} + featureNames.at(i));
+        }
+    }
+
+    return defines;
+}
+
+std::vector<std::string> App::ProgramPermutations::StageDefines(GLenum stage, Key key)
+{
+    std::vector<std::string> defines = Defines(StageFeatures(stage, key));
+    defines.emplace_back("SEPARABLE");
+
+    return defines;
+}
+
+App::Shader::Sources App::ProgramPermutations::LoadSources(Key key)
+{
+    std::vector<std::string> const defines = Defines(key);
+
+    // The files shared by all the permutations are only read once (see ShaderSource)
+    return {App::ShaderSource::Load("vert.glsl", defines),
+            App::ShaderSource::Load("frag.glsl", defines)};
+}
+
+std::string App::ProgramPermutations::LoadStageSource(GLenum stage, Key key)
+{
+    return App::ShaderSource::Load(stage == GL_VERTEX_SHADER ? "vert.glsl" : "frag.glsl",
+                                   StageDefines(stage, key));
+}
+
+std::string App::ProgramPermutations::ToString(Key key)
+{
+    std::string names;
+    for (std::size_t i = 0; i < featureNames.size(); ++i)
+    {
+        if ((key & (1U << i)) != 0)
+        {
+            names += names.empty() ? "" : ",";
+            names += featureNames.at(i);
+        }
+    }
+
+    return names.empty() ? "none" : names;
+}
+
+GLuint App::ProgramPermutations::Build(App::Shader::Sources const &sources)
+{
+    std::uint64_t const cacheKey = App::ProgramCache::Key(sources.vertex, sources.fragment);
+    GLuint program = App::ProgramCache::Load(cacheKey);
+    if (program == 0)
+    {
+        program = App::Shader::CreateProgram(sources.vertex, sources.fragment);
+        App::ProgramCache::Store(cacheKey, program);
+    }
+
+    return program;
+}
+
+GLuint App::ProgramPermutations::Get(Key key)
+{
+    requested.insert(key);
+
+    if (auto const found = programs.find(key); found != programs.end())
+    {
+        ++hits;
+        useOrder.splice(useOrder.begin(), useOrder, found->second.use);
+        return found->second.program;
+    }
+
+    TRACE_SCOPE("ProgramPermutations::Build");
+    ++misses;
+
+    GLuint const program = Build(LoadSources(key));
+    if (program != 0)
+    {
+        Add(key, program);
+    }
+
+    return program;
+}
+
+App::ProgramPermutations::Pipeline App::ProgramPermutations::GetPipeline(Key key)
+{
+    requested.insert(key);
+
+    if (auto const found = pipelines.find(key); found != pipelines.end())
+    {
+        ++hits;
+        return found->second;
+    }
+
+    TRACE_SCOPE("ProgramPermutations::BuildPipeline");
+    ++misses;
+
+    // Submit the missing stages together, then finish them
+    std::array<GLenum, 2> const stages = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+    std::array<StageBuild, 2> builds{};
+    std::array<GLuint, 2> stageProgram{};
+    for (std::size_t i = 0; i < stages.size(); ++i)
+    {
+        auto const found = stagePrograms.find(StageKey(stages.at(i), key));
+        if (found != stagePrograms.end())
+        {
+            stageProgram.at(i) = found->second;
+        }
+        else
+        {
+            builds.at(i) = SubmitStage(stages.at(i), key);
+        }
+    }
+    for (std::size_t i = 0; i < stages.size(); ++i)
+    {
+        if (stageProgram.at(i) == 0 && builds.at(i).stage != 0)
+        {
+            stageProgram.at(i) = FinishStage(builds.at(i));
+            if (stageProgram.at(i) != 0)
+            {
+                stagePrograms[StageKey(stages.at(i), key)] = stageProgram.at(i);
+            }
+        }
+    }
+
+    if (stageProgram[0] == 0 || stageProgram[1] == 0)
+    {
+        return {};
+    }
+
+    Pipeline const pipeline = CreatePipeline(stageProgram[0], stageProgram[1]);
+    pipelines[key] = pipeline;
+    return pipeline;
+}
+
+App::ProgramPermutations::Pipeline App::ProgramPermutations::RebuildPipeline(Key key)
+{
+    TRACE_SCOPE("ProgramPermutations::RebuildPipeline");
+
+    StageBuild vertex = SubmitStage(GL_VERTEX_SHADER, key);
+    StageBuild fragment = SubmitStage(GL_FRAGMENT_SHADER, key);
+    GLuint const vertexProgram = FinishStage(vertex);
+    GLuint const fragmentProgram = FinishStage(fragment);
+
+    if (vertexProgram == 0 || fragmentProgram == 0)
+    {
+        for (GLuint const program : {vertexProgram, fragmentProgram})
+        {
+            if (program != 0)
+            {
+                DeleteProgram(program);
+            }
+        }
+        return {};
+    }
+
+    // Everything else was built from the previous sources
+    Clear();
+    stagePrograms[StageKey(GL_VERTEX_SHADER, key)] = vertexProgram;
+    stagePrograms[StageKey(GL_FRAGMENT_SHADER, key)] = fragmentProgram;
+    Pipeline const pipeline = CreatePipeline(vertexProgram, fragmentProgram);
+    pipelines[key] = pipeline;
+    return pipeline;
+}
+
+void App::ProgramPermutations::Insert(Key key, GLuint program)
+{
+    if (auto const found = programs.find(key); found != programs.end())
+    {
+        if (found->second.program != program)
+        {
+            DeleteProgram(found->second.program);
+        }
+        useOrder.erase(found->second.use);
+        programs.erase(found);
+    }
+
+    Add(key, program);
+}
+
+void App::ProgramPermutations::Prewarm(std::string const &listPath)
+{
+    TRACE_SCOPE("ProgramPermutations::Prewarm");
+
+    std::ifstream list(listPath);
+    std::set<Key> keys;
+    for (std::string line; std::getline(list, line);)
+    {
+        Key key = 0;
+        if (ParseFeatures(line, key) && !programs.contains(key))
+        {
+            keys.insert(key);
+        }
+    }
+
+    if (separable)
+    {
+        for (Key const key : keys)
+        {
+            if (GetPipeline(key).pipeline != 0)
+            {
+                ++prewarmed;
+            }
+        }
+        return;
+    }
+
+    // Submit all the programs that are not in the binary cache before finishing any, so that the
+    // driver can compile them in parallel
+    struct Build
+    {
+        Key key;
+        std::uint64_t cacheKey;
+        App::Shader::PendingProgram pending;
+    };
+    std::vector<Build> builds;
+
+    for (Key const key : keys)
+    {
+        App::Shader::Sources const sources = LoadSources(key);
+        std::uint64_t const cacheKey = App::ProgramCache::Key(sources.vertex, sources.fragment);
+        if (GLuint const program = App::ProgramCache::Load(cacheKey); program != 0)
+        {
+            Add(key, program);
+            ++prewarmed;
+            continue;
+        }
+        builds.push_back({key, cacheKey, App::Shader::Submit(sources.vertex, sources.fragment)});
+    }
+
+    for (Build &build : builds)
+    {
+        GLuint const program = App::Shader::Finish(build.pending);
+        if (program != 0)
+        {
+            App::ProgramCache::Store(build.cacheKey, program);
+            Add(build.key, program);
+            ++prewarmed;
+        }
+    }
+}
+
+void App::ProgramPermutations::SaveUsed(std::string const &listPath)
+{
+    std::ofstream list(listPath);
+    for (Key const key : requested)
+    {
+        list << ToString(key) << '\n';
+    }
+
+    if (!list)
+    {
+        std::cerr << "Could not write the permutation list " << listPath << std::endl;
+    }
+}
+
+void App::ProgramPermutations::Clear()
+{
+    for (auto const &[key, resident] : programs)
+    {
+        DeleteProgram(resident.program);
+    }
+    programs.clear();
+    useOrder.clear();
+
+    for (auto &[key, pipeline] : pipelines)
+    {
+        glDeleteProgramPipelines(1, &pipeline.pipeline);
+    }
+    pipelines.clear();
+    for (auto const &[key, program] : stagePrograms)
+    {
+        DeleteProgram(program);
+    }
+    stagePrograms.clear();
+}
+
+void App::ProgramPermutations::Dump(std::ostream &out)
+{
+    out << "Program permutations: " << hits << " hits, " << misses << " misses, " << prewarmed
+        << " prewarmed, " << evictions << " evicted, " << programs.size() << " resident";
+    if (separable)
+    {
+        out << ", " << stagePrograms.size() << " stage programs, " << pipelines.size()
+            << " pipelines";
+    }
+    out << '\n';
+}
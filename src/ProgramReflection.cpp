@@ -0,0 +1,305 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "App/App.h"
+#include "App/ProgramReflection.h"
+#include "App/Trace.h"
+
+namespace {
+
+using App::ProgramReflection::Kind;
+using App::ProgramReflection::Resource;
+
+/// A slot of the hash table (empty when `program` is 0)
+struct Slot
+{
+    GLuint program = 0;
+    std::uint64_t id = 0;
+    Resource resource{};
+    bool valueSet = false;
+    std::array<std::uint32_t, 16> value{}; // Shadow of the last value set (a mat4 at most)
+};
+
+// Open addressing with linear probing; the capacity is a power of two and the table is kept at most
+// half full
+constexpr std::size_t initialCapacity = 64;
+
+std::vector<Slot> table(initialCapacity); // NOLINT
+std::size_t slotsUsed = 0;                // NOLINT
+
+unsigned long long issued = 0; // NOLINT
+unsigned long long elided = 0; // NOLINT
+
+/// Hash of a (program, kind, name id) key (splitmix64 finalizer)
+std::size_t HashOf(GLuint program, Kind kind, std::uint64_t id)
+{
+    std::uint64_t x = id + ((std::uint64_t{program} << 8U | static_cast<std::uint64_t>(kind)) *
+                            0x9e3779b97f4a7c15ULL);
+    x = (x ^ (x >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27U)) * 0x94d049bb133111ebULL;
+    return static_cast<std::size_t>(x ^ (x >> 31U));
+}
+
+Slot *FindSlot(GLuint program, Kind kind, std::uint64_t id)
+{
+    std::size_t const mask = table.size() - 1;
+    for (std::size_t i = HashOf(program, kind, id) & mask;; i = (i + 1) & mask)
+    {
+        Slot &slot = table[i];
+        if (slot.program == 0)
+        {
+            return nullptr;
+        }
+        if (slot.program == program && slot.id == id && slot.resource.kind == kind)
+        {
+            return &slot;
+        }
+    }
+}
+
+void InsertSlot(Slot const &slot);
+
+/// Rebuild the table with the given capacity, keeping the slots that match `keep`
+template <typename Predicate>
+void Rehash(std::size_t capacity, Predicate keep)
+{
+    std::vector<Slot> old(capacity);
+    old.swap(table);
+    slotsUsed = 0;
+
+    for (Slot const &slot : old)
+    {
+        if (slot.program != 0 && keep(slot))
+        {
+            InsertSlot(slot);
+        }
+    }
+}
+
+void InsertSlot(Slot const &slot)
+{
+    if ((slotsUsed + 1) * 2 > table.size())
+    {
+        Rehash(table.size() * 2, [](Slot const &) { return true; });
+    }
+
+    std::size_t const mask = table.size() - 1;
+    std::size_t i = HashOf(slot.program, slot.resource.kind, slot.id) & mask;
+    while (table[i].program != 0)
+    {
+        i = (i + 1) & mask;
+    }
+    table[i] = slot;
+    ++slotsUsed;
+}
+
+void Add(GLuint program, std::string name, Resource const &resource)
+{
+    // Arrays are reported as "name[0]": look them up by their plain name
+    if (name.ends_with("[0]"))
+    {
+        name.resize(name.size() - 3);
+    }
+
+    Slot slot{};
+    slot.program = program;
+    slot.id = App::ProgramReflection::Id(name);
+    slot.resource = resource;
+    InsertSlot(slot);
+}
+
+#ifdef DEBUG
+/// Whether a value of type `requested` can be stored into a uniform of type `reflected`
+bool Compatible(GLenum reflected, GLenum requested)
+{
+    // Integers also set booleans and samplers
+    return reflected == requested ||
+           (requested == GL_INT && reflected != GL_FLOAT && reflected != GL_FLOAT_VEC2 &&
+            reflected != GL_FLOAT_VEC3 && reflected != GL_FLOAT_VEC4 &&
+            reflected != GL_FLOAT_MAT4);
+}
+#endif
+
+/// The shadow of a uniform if `value` differs from it (and updates it), nullptr if the call can be
+/// elided
+Slot *Update(GLuint program, std::uint64_t id, [[maybe_unused]] GLenum type, void const *value,
+             std::size_t size)
+{
+    Slot *slot = FindSlot(program, Kind::Uniform, id);
+    if (slot == nullptr || slot->resource.location < 0)
+    {
+        return nullptr;
+    }
+
+#ifdef DEBUG
+    if (!Compatible(slot->resource.type, type))
+    {
+        std::cerr << "Uniform type mismatch (program " << program << ", location "
+                  << slot->resource.location << ")" << std::endl;
+        return nullptr;
+    }
+#endif
+
+    if (slot->valueSet && std::memcmp(slot->value.data(), value, size) == 0)
+    {
+        ++elided;
+        return nullptr;
+    }
+
+    std::memcpy(slot->value.data(), value, size);
+    slot->valueSet = true;
+    ++issued;
+    return slot;
+}
+
+} // namespace
+
+void App::ProgramReflection::Reflect(GLuint program)
+{
+    TRACE_SCOPE("ProgramReflection::Reflect");
+
+    Forget(program);
+
+    GLint count = 0;
+    GLint maxLength = 0;
+    std::string name;
+
+    // Uniforms
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    for (GLint i = 0; i < count; ++i)
+    {
+        name.resize(static_cast<std::size_t>(maxLength));
+        GLsizei length = 0;
+        Resource resource{Kind::Uniform, 0, 0, -1, -1};
+        glGetActiveUniform(program, static_cast<GLuint>(i), maxLength, &length, &resource.size,
+                           &resource.type, name.data());
+        name.resize(static_cast<std::size_t>(length));
+
+        auto const index = static_cast<GLuint>(i);
+        glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &resource.blockIndex);
+        resource.location = glGetUniformLocation(program, name.c_str());
+        Add(program, name, resource);
+    }
+
+    // Uniform blocks
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+    for (GLint i = 0; i < count; ++i)
+    {
+        name.resize(static_cast<std::size_t>(maxLength));
+        GLsizei length = 0;
+        auto const index = static_cast<GLuint>(i);
+        glGetActiveUniformBlockName(program, index, maxLength, &length, name.data());
+        name.resize(static_cast<std::size_t>(length));
+
+        Resource resource{Kind::UniformBlock, 0, 0, i, -1};
+        glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_DATA_SIZE, &resource.size);
+        Add(program, name, resource);
+    }
+
+    // Vertex attributes
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+    for (GLint i = 0; i < count; ++i)
+    {
+        name.resize(static_cast<std::size_t>(maxLength));
+        GLsizei length = 0;
+        Resource resource{Kind::Attribute, 0, 0, -1, -1};
+        glGetActiveAttrib(program, static_cast<GLuint>(i), maxLength, &length, &resource.size,
+                          &resource.type, name.data());
+        name.resize(static_cast<std::size_t>(length));
+
+        resource.location = glGetAttribLocation(program, name.c_str());
+        Add(program, name, resource);
+    }
+}
+
+void App::ProgramReflection::Forget(GLuint program)
+{
+    Rehash(table.size(), [&](Slot const &slot) { return slot.program != program; });
+}
+
+App::ProgramReflection::Resource const *App::ProgramReflection::Find(GLuint program, Kind kind,
+                                                                     std::uint64_t id)
+{
+    Slot const *slot = FindSlot(program, kind, id);
+    return slot != nullptr ? &slot->resource : nullptr;
+}
+
+GLint App::ProgramReflection::UniformLocation(GLuint program, std::uint64_t id)
+{
+    Resource const *resource = Find(program, Kind::Uniform, id);
+    return resource != nullptr ? resource->location : -1;
+}
+
+GLint App::ProgramReflection::AttributeLocation(GLuint program, std::uint64_t id)
+{
+    Resource const *resource = Find(program, Kind::Attribute, id);
+    return resource != nullptr ? resource->location : -1;
+}
+
+GLuint App::ProgramReflection::UniformBlockIndex(GLuint program, std::uint64_t id)
+{
+    Resource const *resource = Find(program, Kind::UniformBlock, id);
+    return resource != nullptr ? static_cast<GLuint>(resource->location) : GL_INVALID_INDEX;
+}
+
+void App::ProgramReflection::SetUniform(GLuint program, std::uint64_t id, GLint value)
+{
+    if (Slot const *slot = Update(program, id, GL_INT, &value, sizeof(value)))
+    {
+        glProgramUniform1i(program, slot->resource.location, value);
+    }
+}
+
+void App::ProgramReflection::SetUniform(GLuint program, std::uint64_t id, GLfloat value)
+{
+    if (Slot const *slot = Update(program, id, GL_FLOAT, &value, sizeof(value)))
+    {
+        glProgramUniform1f(program, slot->resource.location, value);
+    }
+}
+
+void App::ProgramReflection::SetUniform(GLuint program, std::uint64_t id,
+                                        std::array<GLfloat, 2> const &value)
+{
+    if (Slot const *slot = Update(program, id, GL_FLOAT_VEC2, value.data(), sizeof(value)))
+    {
+        glProgramUniform2fv(program, slot->resource.location, 1, value.data());
+    }
+}
+
+void App::ProgramReflection::SetUniform(GLuint program, std::uint64_t id,
+                                        std::array<GLfloat, 3> const &value)
+{
+    if (Slot const *slot = Update(program, id, GL_FLOAT_VEC3, value.data(), sizeof(value)))
+    {
+        glProgramUniform3fv(program, slot->resource.location, 1, value.data());
+    }
+}
+
+void App::ProgramReflection::SetUniform(GLuint program, std::uint64_t id,
+                                        std::array<GLfloat, 4> const &value)
+{
+    if (Slot const *slot = Update(program, id, GL_FLOAT_VEC4, value.data(), sizeof(value)))
+    {
+        glProgramUniform4fv(program, slot->resource.location, 1, value.data());
+    }
+}
+
+void App::ProgramReflection::SetUniform(GLuint program, std::uint64_t id,
+                                        std::array<GLfloat, 16> const &value)
+{
+    if (Slot const *slot = Update(program, id, GL_FLOAT_MAT4, value.data(), sizeof(value)))
+    {
+        glProgramUniformMatrix4fv(program, slot->resource.location, 1, GL_FALSE, value.data());
+    }
+}
+
+void App::ProgramReflection::Dump(std::ostream &out)
+{
+    out << "Uniform updates: " << issued << " issued, " << elided << " elided\n";
+}
@@ -0,0 +1,234 @@
+#include <array>
+#include <iostream>
+
+#include "SDL2/SDL.h"
+
+#include "App/App.h"
+#include "App/Shader.h"
+#include "App/StateCache.h"
+#include "App/Trace.h"
+
+namespace {
+
+// From GL_KHR_parallel_shader_compile / GL_ARB_parallel_shader_compile (same values), which the
+// generated glad loader does not include
+constexpr GLenum completionStatusKhr = 0x91B1;  // GL_COMPLETION_STATUS_KHR
+constexpr GLuint driverChosenThreadCount = ~0U; // Lets the driver decide (0xFFFFFFFF)
+using MaxShaderCompilerThreadsProc = void(APIENTRYP)(GLuint count);
+
+bool parallelCompile = false; // NOLINT
+
+/// Start compiling a shader (no status check, see `ShaderCompiled`)
+///
+/// @param type Determine which shader to compile
+/// @param source The shader source code
+/// @return id of the shader object
+GLuint SubmitShader(GLenum type, std::string const &source)
+{
+    // Create shader object
+    GLuint const shaderObject = glCreateShader(type);
+
+    // Specify the shader source code for the object
+    char const *src = source.c_str();
+    glShaderSource(shaderObject, 1, &src, nullptr);
+
+    // Compile the shader object
+    glCompileShader(shaderObject);
+
+    return shaderObject;
+}
+
+/// Check for compilation errors, printing the info log of a broken shader
+///
+/// @return bool whether the shader compiled
+bool ShaderCompiled(GLuint shaderObject)
+{
+    GLint success = GL_FALSE;
+    glGetShaderiv(shaderObject, GL_COMPILE_STATUS, &success);
+    if (success == GL_FALSE)
+    {
+        std::array<char, MAX_GL_INFO_LOG_LEN> infoLog = {0};
+        glGetShaderInfoLog(shaderObject, MAX_GL_INFO_LOG_LEN, nullptr, infoLog.data());
+        std::cerr << "ERROR::SHADER::COMPILATION_FAILED\n" << infoLog.data() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+void App::Shader::Initialize()
+{
+    char const *maxThreadsName = nullptr;
+    if (SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile") == SDL_TRUE)
+    {
+        maxThreadsName = "glMaxShaderCompilerThreadsKHR";
+    }
+    else if (SDL_GL_ExtensionSupported("GL_ARB_parallel_shader_compile") == SDL_TRUE)
+    {
+        maxThreadsName = "glMaxShaderCompilerThreadsARB";
+    }
+
+    auto const maxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>( // NOLINT
+        maxThreadsName != nullptr ? SDL_GL_GetProcAddress(maxThreadsName) : nullptr);
+    parallelCompile = maxShaderCompilerThreads != nullptr;
+
+    if (parallelCompile)
+    {
+        maxShaderCompilerThreads(driverChosenThreadCount);
+    }
+}
+
+bool App::Shader::ParallelCompileSupported()
+{
+    return parallelCompile;
+}
+
+App::Shader::PendingProgram App::Shader::Submit(std::string const &vertexShaderSource,
+                                                std::string const &fragmentShaderSource)
+{
+    TRACE_SCOPE("Shader::Submit");
+
+    PendingProgram pending{};
+
+    // Create a new program object
+    pending.program = glCreateProgram();
+
+    // Compile shaders
+    pending.shaders = {
+        SubmitShader(GL_VERTEX_SHADER, vertexShaderSource),
+        SubmitShader(GL_FRAGMENT_SHADER, fragmentShaderSource),
+    };
+
+    //- Link shader programs (.cpp + .cpp -> executable)
+
+    // Associate (attach) the shaders to the program object
+    for (GLuint const shader : pending.shaders)
+    {
+        glAttachShader(pending.program, shader);
+    }
+
+    // Keep the linked binary retrievable for the program cache
+    glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    // Link a program object. Linking does not wait for the compilation either: a shader that fails
+    // to compile makes the link fail, which `Finish` reports
+    glLinkProgram(pending.program);
+
+    return pending;
+}
+
+App::Shader::PendingProgram App::Shader::SubmitStage(GLenum type, std::string const &source)
+{
+    TRACE_SCOPE("Shader::SubmitStage");
+
+    PendingProgram pending{};
+    pending.program = glCreateProgram();
+    pending.shaders = {SubmitShader(type, source), 0};
+
+    glAttachShader(pending.program, pending.shaders[0]);
+    glProgramParameteri(pending.program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(pending.program);
+
+    return pending;
+}
+
+bool App::Shader::IsReady(PendingProgram const &pending)
+{
+    if (!parallelCompile)
+    {
+        return true;
+    }
+
+    GLint completed = GL_FALSE;
+    glGetProgramiv(pending.program, completionStatusKhr, &completed);
+    return completed == GL_TRUE;
+}
+
+GLuint App::Shader::Finish(PendingProgram &pending)
+{
+    TRACE_SCOPE("Shader::Finish");
+
+    GLuint programObject = pending.program;
+
+    // Check the status of the link (this is where we wait for the compiler if it is not done yet)
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(programObject, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_FALSE)
+    {
+        // Print why the shaders failed to compile, if they did (the logs of all of them)
+        bool compiled = true;
+        for (GLuint const shader : pending.shaders)
+        {
+            compiled = (shader == 0 || ShaderCompiled(shader)) && compiled;
+        }
+        if (compiled)
+        {
+            std::array<char, MAX_GL_INFO_LOG_LEN> infoLog = {0};
+            glGetProgramInfoLog(programObject, static_cast<GLsizei>(infoLog.size()), nullptr,
+                                infoLog.data());
+            std::cerr << "ERROR::PROGRAM::LINKING_FAILED\n" << infoLog.data() << std::endl;
+        }
+
+        glDeleteProgram(programObject);
+        programObject = 0;
+    }
+
+#ifdef DEBUG
+    //- Validation
+
+    // OpenGL requires a VAO to be bound when you validate or use a shader program that interacts
+    // with vertex attributes.
+    //
+    // [extra] Bind the VAO before validating the program
+    // [why?] b/c otherwise we get the following error:  No vertex array object bound
+    if (programObject != 0)
+    {
+        App::StateCache::BindVertexArray(App::vertexArrayObject);
+
+        // Validate the program
+        glValidateProgram(programObject);
+
+        GLint validateStatus = GL_FALSE;
+        glGetProgramiv(programObject, GL_VALIDATE_STATUS, &validateStatus);
+        if (validateStatus == GL_FALSE)
+        {
+            std::array<char, MAX_GL_INFO_LOG_LEN> infoLog = {0};
+            glGetProgramInfoLog(programObject, static_cast<GLsizei>(infoLog.size()), nullptr,
+                                infoLog.data());
+            std::cerr << "ERROR::PROGRAM::VALIDATION_FAILED\n" << infoLog.data() << std::endl;
+        }
+
+        // [extra] Unbind the VAO after validation
+        // [why?] b/c otherwise we get the following error:  No vertex array object bound
+        App::StateCache::BindVertexArray(0);
+    }
+#endif
+
+    // Once our final program object has been created, we can detach and delete the individual
+    // shaders (deleting the program above detached them already)
+    for (GLuint const shader : pending.shaders)
+    {
+        if (shader == 0)
+        {
+            continue;
+        }
+        if (programObject != 0)
+        {
+            glDetachShader(programObject, shader);
+        }
+        glDeleteShader(shader);
+    }
+
+    pending = PendingProgram{};
+    return programObject;
+}
+
+GLuint App::Shader::CreateProgram(std::string const &vertexShaderSource,
+                                  std::string const &fragmentShaderSource)
+{
+    PendingProgram pending = Submit(vertexShaderSource, fragmentShaderSource);
+    return Finish(pending);
+}
@@ -0,0 +1,547 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "App/ShaderMinifier.h"
+
+namespace {
+
+bool IsWord(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_' || c == '.';
+}
+
+bool IsOperator(char c)
+{
+    return std::string_view{"+-*/%<>=!&|^"}.find(c) != std::string_view::npos;
+}
+
+bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/// Whether two tokens ending and starting with these characters must stay apart
+bool NeedsSpace(char previous, char next)
+{
+    return (IsWord(previous) && IsWord(next)) || (IsOperator(previous) && IsOperator(next));
+}
+
+std::string_view Trim(std::string_view text)
+{
+    while (!text.empty() && IsSpace(text.front()))
+    {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && IsSpace(text.back()))
+    {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+/// Append text with its whitespace collapsed to what separates tokens
+void AppendCollapsed(std::string &out, std::string_view text, bool spaceBefore)
+{
+    bool pendingSpace = spaceBefore;
+    for (char const c : text)
+    {
+        if (IsSpace(c) || c == '\n')
+        {
+            pendingSpace = true;
+            continue;
+        }
+        if (pendingSpace && !out.empty() && NeedsSpace(out.back(), c))
+        {
+            out += ' ';
+        }
+        out += c;
+        pendingSpace = false;
+    }
+}
+
+/// The source without comments and line continuations
+std::string StripComments(std::string_view source)
+{
+    std::string out;
+    out.reserve(source.size());
+
+    for (std::size_t i = 0; i < source.size(); ++i)
+    {
+        char const c = source[i];
+        char const next = i + 1 < source.size() ? source[i + 1] : '\0';
+
+        if (c == '\\' && next == '\n')
+        {
+            ++i;
+        }
+        else if (c == '/' && next == '/')
+        {
+            i = std::min(source.find('\n', i), source.size()) - 1;
+        }
+        else if (c == '/' && next == '*')
+        {
+            std::size_t const end = source.find("*/", i + 2);
+            i = end == std::string_view::npos ? source.size() : end + 1;
+            out += ' ';
+        }
+        else
+        {
+            out += c;
+        }
+    }
+
+    return out;
+}
+
+/// Whether a macro is defined, or cannot be known (defined by the implementation, or by a section
+/// the minifier keeps as is)
+enum class Truth : std::uint8_t
+{
+    False,
+    True,
+    Unknown,
+};
+
+/// The state of the conditional section being read
+enum class Section : std::uint8_t
+{
+    Taking,   // In the branch whose condition holds: kept, without the directives
+    Skipping, // Not in a branch that holds yet: dropped
+    Done,     // Past the branch that held: dropped
+    Verbatim, // Condition unknown: the directives and all the branches are kept
+};
+
+struct OpenSection
+{
+    Section state;
+    bool keepEndif; // Whether the `#endif` is kept (a directive of the section was)
+};
+
+class Minifier
+{
+  public:
+    std::string Run(std::string_view source)
+    {
+        std::string const stripped = StripComments(source);
+        out.reserve(stripped.size());
+
+        std::string_view remaining = stripped;
+        while (!remaining.empty())
+        {
+            std::size_t const end = remaining.find('\n');
+            std::string_view const line = Trim(remaining.substr(0, end));
+            remaining.remove_prefix(end == std::string_view::npos ? remaining.size() : end + 1);
+
+            if (!line.empty() && line.front() == '#')
+            {
+                Directive(Trim(line.substr(1)));
+            }
+            else if (Emitting() && !line.empty())
+            {
+                AppendCollapsed(out, line, true);
+                codeLine = true;
+            }
+        }
+
+        if (codeLine)
+        {
+            out += '\n';
+        }
+        return std::move(out);
+    }
+
+  private:
+    std::string out;
+    bool codeLine = false; // Whether `out` ends with an unterminated line of code
+    std::vector<OpenSection> sections;
+    std::unordered_map<std::string, std::string> macros; // Defined, with their value
+    std::unordered_set<std::string> unknownMacros;       // Maybe defined
+
+    bool Emitting() const
+    {
+        for (OpenSection const &section : sections)
+        {
+            if (section.state != Section::Taking && section.state != Section::Verbatim)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool InVerbatim() const
+    {
+        for (OpenSection const &section : sections)
+        {
+            if (section.state == Section::Verbatim)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Emit a directive on its own line, with the whitespace of its arguments collapsed unless they
+    /// are already
+    void EmitDirective(std::string_view name, std::string_view arguments, bool collapse = true)
+    {
+        if (codeLine)
+        {
+            out += '\n';
+            codeLine = false;
+        }
+        out += '#';
+        out += name;
+        if (!arguments.empty())
+        {
+            out += ' ';
+            if (collapse)
+            {
+                AppendCollapsed(out, arguments, false);
+            }
+            else
+            {
+                out += arguments;
+            }
+        }
+        out += '\n';
+    }
+
+    Truth Defined(std::string const &name) const
+    {
+        // Predefined by the implementation (__VERSION__, GL_core_profile, extension names, ...)
+        if (name.starts_with("GL_") || name.starts_with("__") || unknownMacros.contains(name))
+        {
+            return Truth::Unknown;
+        }
+        return macros.contains(name) ? Truth::True : Truth::False;
+    }
+
+    void Directive(std::string_view line)
+    {
+        std::size_t nameEnd = 0;
+        while (nameEnd < line.size() && IsWord(line[nameEnd]))
+        {
+            ++nameEnd;
+        }
+        std::string_view const name = line.substr(0, nameEnd);
+        std::string_view const arguments = Trim(line.substr(nameEnd));
+
+        if (name == "if" || name == "ifdef" || name == "ifndef")
+        {
+            if (!Emitting())
+            {
+                sections.push_back({Section::Done, false});
+                return;
+            }
+
+            Truth truth = name == "if" ? Evaluate(arguments) : Defined(std::string{arguments});
+            if (name == "ifndef" && truth != Truth::Unknown)
+            {
+                truth = truth == Truth::True ? Truth::False : Truth::True;
+            }
+            Open(truth, name, arguments);
+        }
+        else if (name == "elif" || name == "else")
+        {
+            if (sections.empty())
+            {
+                EmitDirective(name, arguments); // Let the compiler report it
+                return;
+            }
+
+            OpenSection &section = sections.back();
+            switch (section.state)
+            {
+                case Section::Verbatim:
+                    EmitDirective(name, arguments);
+                    break;
+                case Section::Taking:
+                    section.state = Section::Done;
+                    break;
+                case Section::Skipping:
+                {
+                    sections.pop_back();
+                    Truth const truth = name == "else" ? Truth::True : Evaluate(arguments);
+                    Open(truth, "if", arguments);
+                    break;
+                }
+                case Section::Done:
+                    break;
+            }
+        }
+        else if (name == "endif")
+        {
+            if (sections.empty() || sections.back().keepEndif)
+            {
+                EmitDirective(name, {});
+            }
+            if (!sections.empty())
+            {
+                sections.pop_back();
+            }
+        }
+        else if (!Emitting())
+        {
+            return;
+        }
+        else if (name == "define" || name == "undef")
+        {
+            std::size_t macroEnd = 0;
+            while (macroEnd < arguments.size() && IsWord(arguments[macroEnd]))
+            {
+                ++macroEnd;
+            }
+            std::string const macro{arguments.substr(0, macroEnd)};
+            if (InVerbatim())
+            {
+                unknownMacros.insert(macro);
+            }
+            else if (name == "define")
+            {
+                macros[macro] = Trim(arguments.substr(macroEnd));
+                unknownMacros.erase(macro);
+            }
+            else
+            {
+                macros.erase(macro);
+                unknownMacros.erase(macro);
+            }
+
+            // Keep an object-like macro whose value starts with a parenthesis apart from it
+            std::string_view const rest = arguments.substr(macroEnd);
+            std::string directive = macro;
+            if (!rest.empty() && IsSpace(rest.front()) && !Trim(rest).empty())
+            {
+                directive += ' ';
+            }
+            AppendCollapsed(directive, rest, false);
+            EmitDirective(name, directive, false);
+        }
+        else if (name != "line" && !name.empty())
+        {
+            EmitDirective(name, arguments);
+        }
+    }
+
+    /// Open the section of an `#if` (or of an `#elif` that became the first branch still possible)
+    void Open(Truth truth, std::string_view name, std::string_view arguments)
+    {
+        if (truth == Truth::Unknown)
+        {
+            EmitDirective(name, arguments);
+            sections.push_back({Section::Verbatim, true});
+        }
+        else
+        {
+            sections.push_back({truth == Truth::True ? Section::Taking : Section::Skipping, false});
+        }
+    }
+
+    // `#if` expressions: integers, macros with an integer value, defined, !, unary -, comparisons,
+    // + and -, && and ||. Anything else makes the condition unknown.
+
+    struct Parser
+    {
+        Minifier const &minifier;
+        std::string_view text;
+        bool failed = false;
+
+        void SkipSpaces()
+        {
+            while (!text.empty() && IsSpace(text.front()))
+            {
+                text.remove_prefix(1);
+            }
+        }
+
+        bool Accept(std::string_view token)
+        {
+            SkipSpaces();
+            if (text.starts_with(token))
+            {
+                text.remove_prefix(token.size());
+                return true;
+            }
+            return false;
+        }
+
+        std::string Identifier()
+        {
+            SkipSpaces();
+            std::size_t end = 0;
+            while (end < text.size() &&
+                   (std::isalnum(static_cast<unsigned char>(text[end])) != 0 || text[end] == '_'))
+            {
+                ++end;
+            }
+            std::string name{text.substr(0, end)};
+            text.remove_prefix(end);
+            return name;
+        }
+
+        std::optional<long> Integer(std::string_view digits)
+        {
+            std::string const number{Trim(digits)};
+            char *end = nullptr;
+            long const value = std::strtol(number.c_str(), &end, 0);
+            if (number.empty() || end != number.c_str() + number.size())
+            {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        long Primary()
+        {
+            if (Accept("("))
+            {
+                long const value = Or();
+                failed = failed || !Accept(")");
+                return value;
+            }
+            if (Accept("!"))
+            {
+                return static_cast<long>(Primary() == 0);
+            }
+            if (Accept("-"))
+            {
+                return -Primary();
+            }
+
+            SkipSpaces();
+            if (!text.empty() && std::isdigit(static_cast<unsigned char>(text.front())) != 0)
+            {
+                std::size_t end = 0;
+                while (end < text.size() && IsWord(text[end]))
+                {
+                    ++end;
+                }
+                std::optional<long> const value = Integer(text.substr(0, end));
+                text.remove_prefix(end);
+                failed = failed || !value;
+                return value.value_or(0);
+            }
+
+            std::string const name = Identifier();
+            if (name == "defined")
+            {
+                bool const parenthesized = Accept("(");
+                Truth const truth = minifier.Defined(Identifier());
+                failed = failed || truth == Truth::Unknown || (parenthesized && !Accept(")"));
+                return static_cast<long>(truth == Truth::True);
+            }
+
+            // A macro with an integer value (GLSL makes other identifiers an error)
+            auto const macro = minifier.macros.find(name);
+            std::optional<long> const value =
+                name.empty() || minifier.Defined(name) != Truth::True ? std::nullopt
+                                                                      : Integer(macro->second);
+            failed = failed || !value;
+            return value.value_or(0);
+        }
+
+        long Additive()
+        {
+            long value = Primary();
+            while (!failed)
+            {
+                if (Accept("+"))
+                {
+                    value += Primary();
+                }
+                else if (Accept("-"))
+                {
+                    value -= Primary();
+                }
+                else
+                {
+                    return value;
+                }
+            }
+            return value;
+        }
+
+        long Comparison()
+        {
+            long value = Additive();
+            while (!failed)
+            {
+                if (Accept("=="))
+                {
+                    value = static_cast<long>(value == Additive());
+                }
+                else if (Accept("!="))
+                {
+                    value = static_cast<long>(value != Additive());
+                }
+                else if (Accept("<="))
+                {
+                    value = static_cast<long>(value <= Additive());
+                }
+                else if (Accept(">="))
+                {
+                    value = static_cast<long>(value >= Additive());
+                }
+                else if (Accept("<"))
+                {
+                    value = static_cast<long>(value < Additive());
+                }
+                else if (Accept(">"))
+                {
+                    value = static_cast<long>(value > Additive());
+                }
+                else
+                {
+                    return value;
+                }
+            }
+            return value;
+        }
+
+        long And()
+        {
+            long value = Comparison();
+            while (!failed && Accept("&&"))
+            {
+                value = static_cast<long>((Comparison() != 0) && value != 0);
+            }
+            return value;
+        }
+
+        long Or()
+        {
+            long value = And();
+            while (!failed && Accept("||"))
+            {
+                value = static_cast<long>((And() != 0) || value != 0);
+            }
+            return value;
+        }
+    };
+
+    Truth Evaluate(std::string_view expression) const
+    {
+        Parser parser{*this, expression};
+        long const value = parser.Or();
+        parser.SkipSpaces();
+        if (parser.failed || !parser.text.empty())
+        {
+            return Truth::Unknown;
+        }
+        return value != 0 ? Truth::True : Truth::False;
+    }
+};
+
+} // namespace
+
+std::string App::ShaderMinifier::Minify(std::string_view source)
+{
+    return Minifier{}.Run(source);
+}
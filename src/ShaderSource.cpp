@@ -0,0 +1,350 @@
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+
+#include "App/EmbeddedShaders.h"
+#include "App/ShaderSource.h"
+#include "App/Trace.h"
+
+std::string App::ShaderSource::directory; // NOLINT
+
+namespace {
+
+// Deeper than this is most likely a file including itself
+constexpr int maxIncludeDepth = 16;
+
+/// A file a resolved source was read from disk from, with the modification time it had then
+struct Dependency
+{
+    std::filesystem::path path;
+    std::filesystem::file_time_type modified;
+};
+
+/// A resolved source (includes expanded, no defines injected)
+struct Entry
+{
+    std::string text;
+    std::vector<Dependency> dependencies; // The file itself first, then its includes
+    bool embedded = false;                // Never changes
+};
+
+/// An `#include "file"` directive of a file
+struct Include
+{
+    std::size_t begin;          // Of the directive line in the contents of the file
+    std::size_t end;            // Past the end of the line
+    unsigned long lineNumber;   // Of the directive
+    std::filesystem::path path; // The included file, relative to the shaders directory
+};
+
+/// A file as read, with its include directives located (shared by every source including it)
+struct File
+{
+    std::string contents;
+    std::filesystem::file_time_type modified; // Of a file read from disk
+    std::vector<Include> includes;            // In order
+};
+
+std::mutex cacheMutex;                                               // NOLINT
+std::unordered_map<std::string, Entry> cache;                        // By name -- NOLINT
+std::unordered_map<std::string, std::shared_ptr<File const>> files; // By path -- NOLINT
+unsigned long hits = 0;                                              // NOLINT
+unsigned long misses = 0;                                            // NOLINT
+unsigned long fileReads = 0;                                         // NOLINT
+unsigned long prebuiltLoads = 0;                                     // NOLINT
+// All of the above are guarded by cacheMutex
+
+/// Read a whole file at once
+///
+/// @return bool whether the file could be read
+bool ReadFile(std::filesystem::path const &path, std::string &contents)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    contents.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+    return static_cast<bool>(file);
+}
+
+/// Whether none of the files a resolved source was built from changed since
+bool UpToDate(Entry const &entry)
+{
+    if (entry.embedded)
+    {
+        return true;
+    }
+
+    for (Dependency const &dependency : entry.dependencies)
+    {
+        std::error_code error;
+        auto const modified = std::filesystem::last_write_time(dependency.path, error);
+        if (error || modified != dependency.modified)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// Locate the `#include "file"` directives of a file
+///
+/// @param name the file, relative to the shaders directory (for the messages and the includes)
+/// @return bool whether all the directives are well-formed
+bool FindIncludes(std::filesystem::path const &name, File &file)
+{
+    std::string_view const contents = file.contents;
+    std::size_t begin = 0;
+    for (unsigned long lineNumber = 1; begin < contents.size(); ++lineNumber)
+    {
+        std::size_t const newline = contents.find('\n', begin);
+        std::size_t const end = newline == std::string_view::npos ? contents.size() : newline + 1;
+        std::string_view const line = contents.substr(begin, end - begin);
+
+        std::string_view directive = line.substr(std::min(line.find_first_not_of(" \t"),
+                                                          line.size()));
+        if (directive.starts_with("#include"))
+        {
+            // #include "file"
+            directive.remove_prefix(std::string_view{"#include"}.size());
+            std::size_t const open = directive.find('"');
+            std::size_t const close = directive.find('"', open + 1);
+            if (open == std::string_view::npos || close == std::string_view::npos)
+            {
+                std::cerr << name.string() << ":" << lineNumber << ": malformed #include"
+                          << std::endl;
+                return false;
+            }
+            file.includes.push_back(
+                {begin, end, lineNumber,
+                 name.parent_path() / directive.substr(open + 1, close - open - 1)});
+        }
+        begin = end;
+    }
+
+    return true;
+}
+
+/// Get a shader file by name, from the override directory if there is one, otherwise from the
+/// embedded copies. A file read from disk before is only read again if it was modified since.
+///
+/// @param dependencies where the file read from is appended
+/// @return std::shared_ptr<File const> the file, null if it does not exist or is malformed
+std::shared_ptr<File const> ReadSource(std::filesystem::path const &name,
+                                       std::vector<Dependency> &dependencies)
+{
+    bool const embedded = App::ShaderSource::directory.empty();
+    std::filesystem::path const path =
+        embedded ? name.lexically_normal() : App::ShaderSource::directory / name;
+
+    std::filesystem::file_time_type modified{};
+    if (!embedded)
+    {
+        std::error_code error;
+        modified = std::filesystem::last_write_time(path, error);
+        if (error)
+        {
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<File const> &cached = files[path.generic_string()];
+    if (cached == nullptr || cached->modified != modified)
+    {
+        auto file = std::make_shared<File>();
+        file->modified = modified;
+        bool read = false;
+        if (embedded)
+        {
+            App::EmbeddedShaders::File const *source =
+                App::EmbeddedShaders::Find(path.generic_string());
+            read = source != nullptr;
+            file->contents = read ? source->source : std::string_view{};
+        }
+        else
+        {
+            read = ReadFile(path, file->contents);
+        }
+        if (!read || !FindIncludes(name, *file))
+        {
+            files.erase(path.generic_string());
+            return nullptr;
+        }
+        ++fileReads;
+        cached = std::move(file);
+    }
+
+    dependencies.push_back({path, modified});
+    return cached;
+}
+
+/// Append the contents of a file to `out`, expanding its includes recursively
+///
+/// @return bool whether the file and all its includes could be read
+bool Expand(std::filesystem::path const &path, int depth, std::string &out,
+            std::vector<Dependency> &dependencies)
+{
+    std::size_t const index = dependencies.size();
+    std::shared_ptr<File const> const file = ReadSource(path, dependencies);
+    if (file == nullptr)
+    {
+        if (App::ShaderSource::directory.empty())
+        {
+            std::cerr << "No embedded shader source " << path << std::endl;
+        }
+        else
+        {
+            std::cerr << "Could not read shader source " << App::ShaderSource::directory / path
+                      << std::endl;
+        }
+        return false;
+    }
+
+    out.reserve(out.size() + file->contents.size());
+
+    std::size_t copied = 0;
+    for (Include const &include : file->includes)
+    {
+        out.append(file->contents, copied, include.begin - copied);
+        copied = include.end;
+
+        if (depth == maxIncludeDepth)
+        {
+            std::cerr << path.string() << ":" << include.lineNumber
+                      << ": #include nested too deeply (recursive include?)" << std::endl;
+            return false;
+        }
+
+        out += "#line 1 " + std::to_string(dependencies.size()) + "\n";
+        if (!Expand(include.path, depth + 1, out, dependencies))
+        {
+            return false;
+        }
+        out += "#line " + std::to_string(include.lineNumber + 1) + " " + std::to_string(index) +
+               "\n";
+    }
+    out.append(file->contents, copied);
+
+    // Every line ends with a newline, so that whatever follows starts on its own line
+    if (!out.empty() && out.back() != '\n')
+    {
+        out += '\n';
+    }
+
+    return true;
+}
+
+/// Insert the definitions after the `#version` line (which must come first), then restore the line
+/// numbering of the file
+///
+/// @return std::string the source with the definitions
+std::string InjectDefines(std::string const &source, std::vector<std::string> const &defines)
+{
+    std::string definitions;
+    for (std::string const &define : defines)
+    {
+        definitions += "#define " + define + "\n";
+    }
+
+    std::size_t insertAt = 0;
+    unsigned long nextLine = 1;
+    if (std::size_t const version = source.find("#version"); version != std::string::npos)
+    {
+        std::size_t const end = source.find('\n', version);
+        insertAt = end == std::string::npos ? source.size() : end + 1;
+        auto const lines = std::count(source.begin(), source.begin() + static_cast<long>(insertAt),
+                                      '\n');
+        nextLine = 1 + static_cast<unsigned long>(lines);
+    }
+    definitions += "#line " + std::to_string(nextLine) + " 0\n";
+
+    std::string result;
+    result.reserve(source.size() + definitions.size());
+    result.append(source, 0, insertAt);
+    result += definitions;
+    result.append(source, insertAt);
+    return result;
+}
+
+} // namespace
+
+std::string App::ShaderSource::Load(std::filesystem::path const &name,
+                                    std::vector<std::string> const &defines)
+{
+    TRACE_SCOPE("ShaderSource::Load");
+
+    std::lock_guard<std::mutex> const lock{cacheMutex};
+
+    // The shipped permutations, preprocessed and minified at build time
+    if (directory.empty())
+    {
+        if (App::EmbeddedShaders::File const *prebuilt =
+                App::EmbeddedShaders::Find(PrebuiltName(name, defines)))
+        {
+            ++prebuiltLoads;
+            return std::string{prebuilt->source};
+        }
+    }
+
+    Entry &entry = cache[name.string()];
+    if (!entry.dependencies.empty() && UpToDate(entry))
+    {
+        ++hits;
+    }
+    else
+    {
+        ++misses;
+        entry.text.clear();
+        entry.dependencies.clear();
+        entry.embedded = directory.empty();
+        if (!Expand(name, 0, entry.text, entry.dependencies))
+        {
+            cache.erase(name.string());
+            return {};
+        }
+    }
+
+    return defines.empty() ? entry.text : InjectDefines(entry.text, defines);
+}
+
+std::string App::ShaderSource::PrebuiltName(std::filesystem::path const &name,
+                                            std::vector<std::string> const &defines)
+{
+    std::string permutation;
+    for (std::string const &define : defines)
+    {
+        permutation += (permutation.empty() ? "" : "+") + define;
+    }
+    std::replace(permutation.begin(), permutation.end(), ' ', '=');
+
+    std::filesystem::path stem = name;
+    stem.replace_extension();
+    return stem.generic_string() + "." + (permutation.empty() ? "none" : permutation) +
+           name.extension().string();
+}
+
+void App::ShaderSource::Clear()
+{
+    std::lock_guard<std::mutex> const lock{cacheMutex};
+    cache.clear();
+    files.clear();
+}
+
+void App::ShaderSource::Dump(std::ostream &out)
+{
+    std::lock_guard<std::mutex> const lock{cacheMutex};
+    out << "Shader sources: " << prebuiltLoads << " prebuilt, " << hits << " memoized, " << misses
+        << " resolved, " << fileReads << " files read ("
+        << (directory.empty() ? "embedded" : "from " + directory) << ")\n";
+}
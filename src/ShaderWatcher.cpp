@@ -0,0 +1,142 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "App/App.h"
+#include "App/ShaderWatcher.h"
+
+namespace {
+
+// How often the watcher thread checks whether it should stop
+constexpr int pollTimeoutMs = 100;
+
+// Saving may write several files, or one file in several steps: wait for the burst of events to be
+// over before reading the sources, so that they are read once and complete
+constexpr auto settleTime = std::chrono::milliseconds(50);
+
+std::thread watcher;                    // NOLINT
+std::atomic<bool> stopRequested{false}; // NOLINT
+int inotifyFd = -1;                     // NOLINT
+
+std::mutex sourcesMutex;                 // NOLINT
+App::Shader::Sources latestSources;      // Guarded by sourcesMutex -- NOLINT
+std::atomic<bool> sourcesPending{false}; // Set under sourcesMutex, read without it -- NOLINT
+
+/// Read all the queued inotify events
+///
+/// @return bool whether one of them concerns a shader
+bool DrainEvents()
+{
+    alignas(inotify_event) std::array<char, 4096> buffer{};
+    bool shaderChanged = false;
+
+    ssize_t length = 0;
+    while ((length = read(inotifyFd, buffer.data(), buffer.size())) > 0)
+    {
+        for (ssize_t offset = 0; offset < length;)
+        {
+            inotify_event event{};
+            std::memcpy(&event, buffer.data() + offset, sizeof(event));
+            if (event.len > 0)
+            {
+                // The name is padded with null characters
+                std::string_view const name{buffer.data() + offset + sizeof(event)}; // NOLINT
+                shaderChanged = shaderChanged || name.ends_with(".glsl");
+            }
+            offset += static_cast<ssize_t>(sizeof(event) + event.len);
+        }
+    }
+
+    return shaderChanged;
+}
+
+void Watch(std::function<App::Shader::Sources()> const &load)
+{
+    while (!stopRequested.load(std::memory_order_relaxed))
+    {
+        pollfd descriptor{inotifyFd, POLLIN, 0};
+        if (poll(&descriptor, 1, pollTimeoutMs) <= 0 || !DrainEvents())
+        {
+            continue;
+        }
+
+        std::this_thread::sleep_for(settleTime);
+        DrainEvents();
+
+        App::Shader::Sources sources = load();
+        {
+            std::lock_guard<std::mutex> const lock{sourcesMutex};
+            latestSources = std::move(sources);
+            sourcesPending.store(true, std::memory_order_release);
+        }
+
+        // Make sure an idle main loop picks the change up
+        App::MarkDirty();
+    }
+}
+
+} // namespace
+
+bool App::ShaderWatcher::Start(std::string const &directory,
+                               std::function<App::Shader::Sources()> load)
+{
+    if (watcher.joinable())
+    {
+        return true;
+    }
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0)
+    {
+        return false;
+    }
+
+    // Editors either write the file in place (IN_CLOSE_WRITE) or rename a new file over it
+    // (IN_MOVED_TO)
+    if (inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        close(inotifyFd);
+        inotifyFd = -1;
+        return false;
+    }
+
+    stopRequested = false;
+    watcher = std::thread(Watch, std::move(load));
+    return true;
+}
+
+void App::ShaderWatcher::Stop()
+{
+    if (!watcher.joinable())
+    {
+        return;
+    }
+
+    stopRequested = true;
+    watcher.join();
+    close(inotifyFd);
+    inotifyFd = -1;
+}
+
+bool App::ShaderWatcher::TakeSources(App::Shader::Sources &sources)
+{
+    // Called every frame: skip the lock in the common case where nothing changed
+    if (!sourcesPending.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> const lock{sourcesMutex};
+    sources = std::move(latestSources);
+    sourcesPending.store(false, std::memory_order_relaxed);
+    return true;
+}
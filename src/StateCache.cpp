@@ -0,0 +1,255 @@
+#include <array>
+#include <cstdio>
+
+#include "App/StateCache.h"
+
+namespace {
+
+using App::StateCache::Call;
+
+constexpr std::size_t callCount = static_cast<std::size_t>(Call::Count);
+
+// The capabilities whose enabled state is shadowed; others are always passed through
+constexpr std::array<GLenum, 6> trackedCapabilities = {
+    GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_SCISSOR_TEST, GL_STENCIL_TEST, GL_FRAMEBUFFER_SRGB,
+};
+
+/// A shadowed value, which is unknown until set through the cache for the first time
+template <typename T>
+struct Shadowed
+{
+    T value{};
+    bool known = false;
+
+    /// Update the shadow copy
+    ///
+    /// @return bool whether the value changed (i.e. the call must be issued)
+    bool Set(T const &newValue)
+    {
+        if (known && value == newValue)
+        {
+            return false;
+        }
+
+        value = newValue;
+        known = true;
+        return true;
+    }
+};
+
+struct ShadowState
+{
+    std::array<Shadowed<bool>, trackedCapabilities.size()> capabilities{};
+    Shadowed<std::array<GLint, 4>> viewport{};
+    Shadowed<std::array<GLfloat, 4>> clearColor{};
+    Shadowed<GLuint> program{};
+    Shadowed<GLuint> vertexArray{};
+    Shadowed<GLuint> programPipeline{};
+    Shadowed<GLenum> depthFunc{};
+    Shadowed<GLboolean> depthMask{};
+    Shadowed<GLenum> cullFace{};
+    Shadowed<GLenum> frontFace{};
+    Shadowed<std::array<GLenum, 2>> blendFunc{};
+};
+
+ShadowState shadow;                                          // NOLINT
+std::array<App::StateCache::Counters, callCount> counters{}; // NOLINT
+
+/// Count the call and tell whether it has to be issued
+///
+/// @return bool the value of `changed`
+bool Filter(Call call, bool changed)
+{
+    auto &counter = counters[static_cast<std::size_t>(call)]; // NOLINT
+    ++(changed ? counter.issued : counter.elided);
+    return changed;
+}
+
+/// Index of a tracked capability in `trackedCapabilities`, or -1 if it is not tracked
+int CapabilitySlot(GLenum capability)
+{
+    for (std::size_t i = 0; i < trackedCapabilities.size(); ++i)
+    {
+        if (trackedCapabilities[i] == capability) // NOLINT
+        {
+            return static_cast<int>(i);
+        }
+    }
+
+    return -1;
+}
+
+void SetCapability(GLenum capability, bool enabled)
+{
+    int const slot = CapabilitySlot(capability);
+    bool const changed =
+        slot < 0 || shadow.capabilities[static_cast<std::size_t>(slot)].Set(enabled); // NOLINT
+
+    if (Filter(Call::EnableDisable, changed))
+    {
+        if (enabled)
+        {
+            glEnable(capability);
+        }
+        else
+        {
+            glDisable(capability);
+        }
+    }
+}
+
+} // namespace
+
+void App::StateCache::Enable(GLenum capability)
+{
+    SetCapability(capability, true);
+}
+
+void App::StateCache::Disable(GLenum capability)
+{
+    SetCapability(capability, false);
+}
+
+void App::StateCache::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (Filter(Call::Viewport, shadow.viewport.Set({x, y, width, height})))
+    {
+        glViewport(x, y, width, height);
+    }
+}
+
+void App::StateCache::ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    if (Filter(Call::ClearColor, shadow.clearColor.Set({red, green, blue, alpha})))
+    {
+        glClearColor(red, green, blue, alpha);
+    }
+}
+
+void App::StateCache::UseProgram(GLuint program)
+{
+    if (Filter(Call::UseProgram, shadow.program.Set(program)))
+    {
+        glUseProgram(program);
+    }
+}
+
+void App::StateCache::BindVertexArray(GLuint vertexArray)
+{
+    if (Filter(Call::BindVertexArray, shadow.vertexArray.Set(vertexArray)))
+    {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+void App::StateCache::BindProgramPipeline(GLuint pipeline)
+{
+    if (Filter(Call::BindProgramPipeline, shadow.programPipeline.Set(pipeline)))
+    {
+        glBindProgramPipeline(pipeline);
+    }
+}
+
+void App::StateCache::DepthFunc(GLenum func)
+{
+    if (Filter(Call::DepthFunc, shadow.depthFunc.Set(func)))
+    {
+        glDepthFunc(func);
+    }
+}
+
+void App::StateCache::DepthMask(GLboolean flag)
+{
+    if (Filter(Call::DepthMask, shadow.depthMask.Set(flag)))
+    {
+        glDepthMask(flag);
+    }
+}
+
+void App::StateCache::CullFace(GLenum mode)
+{
+    if (Filter(Call::CullFace, shadow.cullFace.Set(mode)))
+    {
+        glCullFace(mode);
+    }
+}
+
+void App::StateCache::FrontFace(GLenum mode)
+{
+    if (Filter(Call::FrontFace, shadow.frontFace.Set(mode)))
+    {
+        glFrontFace(mode);
+    }
+}
+
+void App::StateCache::BlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+    if (Filter(Call::BlendFunc, shadow.blendFunc.Set({sourceFactor, destinationFactor})))
+    {
+        glBlendFunc(sourceFactor, destinationFactor);
+    }
+}
+
+void App::StateCache::Invalidate()
+{
+    shadow = ShadowState{};
+}
+
+App::StateCache::Counters App::StateCache::GetCounters(Call call)
+{
+    return counters[static_cast<std::size_t>(call)]; // NOLINT
+}
+
+void App::StateCache::ResetCounters()
+{
+    counters = {};
+}
+
+void App::StateCache::Dump(std::ostream &out)
+{
+    std::array<char, 128> line{};
+
+    std::snprintf(line.data(), line.size(), "%-20s %12s %12s\n", "state call", "issued", "elided");
+    out << line.data();
+
+    for (std::size_t i = 0; i < callCount; ++i)
+    {
+        Counters const &c = counters[i]; // NOLINT
+        std::snprintf(line.data(), line.size(), "%-20s %12llu %12llu\n",
+                      CallName(static_cast<Call>(i)), c.issued, c.elided);
+        out << line.data();
+    }
+}
+
+char const *App::StateCache::CallName(Call call)
+{
+    switch (call)
+    {
+        case Call::EnableDisable:
+            return "Enable/Disable";
+        case Call::Viewport:
+            return "Viewport";
+        case Call::ClearColor:
+            return "ClearColor";
+        case Call::UseProgram:
+            return "UseProgram";
+        case Call::BindVertexArray:
+            return "BindVertexArray";
+        case Call::BindProgramPipeline:
+            return "BindProgramPipeline";
+        case Call::DepthFunc:
+            return "DepthFunc";
+        case Call::DepthMask:
+            return "DepthMask";
+        case Call::CullFace:
+            return "CullFace";
+        case Call::FrontFace:
+            return "FrontFace";
+        case Call::BlendFunc:
+            return "BlendFunc";
+        case Call::Count:
+            break;
+    }
+
+    return "?";
+}
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "App/StreamBuffer.h"
+#include "App/Trace.h"
+
+namespace {
+
+using App::StreamBuffer::FencedRange;
+using App::StreamBuffer::Ring;
+
+// How long a single glClientWaitSync may block before trying again (1 ms)
+constexpr GLuint64 waitTimeoutNs = 1'000'000;
+
+unsigned long long allocationCount = 0; // NOLINT
+unsigned long long allocatedBytes = 0;  // NOLINT
+unsigned long waitCount = 0;            // Allocations that had to wait for the GPU -- NOLINT
+double waitTime = 0.0;                  // Milliseconds -- NOLINT
+double maxWaitTime = 0.0;               // Milliseconds -- NOLINT
+unsigned long orphanCount = 0;          // NOLINT
+
+/// Whether [offset, offset + size) overlaps a range in ring order
+bool Overlaps(FencedRange const &range, GLintptr offset, GLsizeiptr size)
+{
+    if (range.start < range.end)
+    {
+        return offset < range.end && range.start < offset + size;
+    }
+    return offset + size > range.start || offset < range.end;
+}
+
+/// Block until the GPU is done with a range, and delete its fence
+void Wait(FencedRange const &range)
+{
+    GLenum status = glClientWaitSync(range.fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+    {
+        TRACE_SCOPE("StreamBuffer::Wait");
+        auto const start = std::chrono::steady_clock::now();
+
+        // Flush the first time so that the fence is guaranteed to be signaled eventually
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED &&
+               status != GL_WAIT_FAILED)
+        {
+            status = glClientWaitSync(range.fence, flags, waitTimeoutNs);
+            flags = 0;
+        }
+
+        std::chrono::duration<double, std::milli> const time =
+            std::chrono::steady_clock::now() - start;
+        ++waitCount;
+        waitTime += time.count();
+        maxWaitTime = std::max(maxWaitTime, time.count());
+    }
+    glDeleteSync(range.fence);
+}
+
+void DeleteFences(Ring &ring)
+{
+    for (FencedRange const &range : ring.inFlight)
+    {
+        glDeleteSync(range.fence);
+    }
+    ring.inFlight.clear();
+}
+
+/// Give the buffer new storage (the GPU keeps reading the old one): the whole ring is free
+void Orphan(Ring &ring)
+{
+    glBufferData(ring.target, ring.size, nullptr, GL_STREAM_DRAW);
+    DeleteFences(ring);
+    ring.head = 0;
+    ring.frameStart = 0;
+    ring.frameWrapped = false;
+    ++orphanCount;
+}
+
+} // namespace
+
+void App::StreamBuffer::Create(Ring &ring, GLenum target, GLsizeiptr size, Mode mode)
+{
+    Destroy(ring);
+
+    ring.target = target;
+    ring.size = size;
+    ring.mode = mode;
+    glGenBuffers(1, &ring.buffer);
+    glBindBuffer(target, ring.buffer);
+    glBufferData(target, size, nullptr, GL_STREAM_DRAW);
+}
+
+void App::StreamBuffer::Destroy(Ring &ring)
+{
+    DeleteFences(ring);
+    glDeleteBuffers(1, &ring.buffer);
+    ring = Ring{};
+}
+
+App::StreamBuffer::Allocation App::StreamBuffer::Map(Ring &ring, GLsizeiptr size,
+                                                     GLsizeiptr alignment)
+{
+    TRACE_SCOPE("StreamBuffer::Map");
+
+    glBindBuffer(ring.target, ring.buffer);
+
+    // Too large for the ring: make room for a few frames of such allocations
+    if (size > ring.size)
+    {
+        ring.size = size * 3;
+        Orphan(ring);
+    }
+
+    GLintptr offset = (ring.head + alignment - 1) / alignment * alignment;
+    if (offset + size > ring.size)
+    {
+        if (ring.mode == Mode::Orphaning)
+        {
+            Orphan(ring);
+        }
+        else if (!ring.frameWrapped && ring.head == ring.frameStart)
+        {
+            ring.frameStart = 0; // Nothing allocated yet this frame
+        }
+        else
+        {
+            ring.frameWrapped = true;
+        }
+        offset = 0;
+    }
+
+    // The frame would overwrite its own data, which has no fence yet
+    if (ring.frameWrapped && offset + size > ring.frameStart)
+    {
+        Orphan(ring);
+        offset = 0;
+    }
+
+    // Wait for the most recent frame using the space (the fences of the older ones are signaled
+    // before it)
+    auto const used = std::find_if(ring.inFlight.rbegin(), ring.inFlight.rend(),
+                                   [&](FencedRange const &range) {
+                                       return Overlaps(range, offset, size);
+                                   });
+    if (used != ring.inFlight.rend())
+    {
+        auto const last = used.base(); // One past the range waited for
+        Wait(*used);
+        std::for_each(ring.inFlight.begin(), last - 1,
+                      [](FencedRange const &range) { glDeleteSync(range.fence); });
+        ring.inFlight.erase(ring.inFlight.begin(), last);
+    }
+
+    // Never an implicit sync: the space is not in use (anymore)
+    constexpr GLbitfield access =
+        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+    void *pointer = glMapBufferRange(ring.target, offset, size, access);
+    if (pointer == nullptr)
+    {
+        return {nullptr, offset};
+    }
+    ring.head = offset + size;
+
+    ++allocationCount;
+    allocatedBytes += static_cast<unsigned long long>(size);
+    return {pointer, offset};
+}
+
+void App::StreamBuffer::Unmap(Ring &ring)
+{
+    glBindBuffer(ring.target, ring.buffer);
+    glUnmapBuffer(ring.target);
+}
+
+void App::StreamBuffer::EndFrame(Ring &ring)
+{
+    bool const frameHasData = ring.frameWrapped || ring.head != ring.frameStart;
+    if (ring.mode == Mode::Unsynchronized && frameHasData)
+    {
+        ring.inFlight.push_back(
+            {glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), ring.frameStart, ring.head});
+    }
+    ring.frameStart = ring.head;
+    ring.frameWrapped = false;
+}
+
+void App::StreamBuffer::Dump(std::ostream &out)
+{
+    out << "Stream buffers: " << allocationCount << " allocations ("
+        << static_cast<double>(allocatedBytes) / (1024.0 * 1024.0) << " MiB), " << waitCount
+        << " waits (" << waitTime << " ms total, " << maxWaitTime << " ms max), " << orphanCount
+        << " orphans\n";
+}
+
+bool App::StreamBuffer::ParseMode(std::string_view name, Mode &mode)
+{
+    for (Mode const candidate : {Mode::Unsynchronized, Mode::Orphaning})
+    {
+        if (name == ToString(candidate))
+        {
+            mode = candidate;
+            return true;
+        }
+    }
+
+    std::cerr << "Unknown stream mode \"" << name << "\" (unsynchronized or orphaning)"
+              << std::endl;
+    return false;
+}
+
+char const *App::StreamBuffer::ToString(Mode mode)
+{
+    return mode == Mode::Orphaning ? "orphaning" : "unsynchronized";
+}
@@ -0,0 +1,122 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "App/Trace.h"
+
+namespace {
+
+// Zones kept per thread; later zones are dropped (and counted) once a buffer is full
+constexpr std::size_t threadBufferCapacity = 1 << 16;
+
+struct ZoneEvent
+{
+    char const *name = nullptr;
+    std::uint64_t begin = 0;
+    std::uint64_t end = 0;
+};
+
+/// The zones of one thread. Only its own thread appends; `count` publishes the appended events to
+/// the writer.
+struct ThreadBuffer
+{
+    std::uint32_t threadId = 0;
+    std::atomic<std::size_t> count{0};
+    std::atomic<std::size_t> dropped{0};
+    std::array<ZoneEvent, threadBufferCapacity> events{};
+};
+
+auto const processStart = std::chrono::steady_clock::now(); // NOLINT
+
+// Every buffer ever created; the mutex is only taken when a thread records its first zone and when
+// writing the trace. Buffers are never freed so that the writer may still read them after their
+// thread exited.
+std::mutex registryMutex;                            // NOLINT
+std::vector<std::unique_ptr<ThreadBuffer>> registry; // NOLINT
+
+ThreadBuffer &RegisterThread()
+{
+    std::lock_guard<std::mutex> const lock{registryMutex};
+
+    registry.push_back(std::make_unique<ThreadBuffer>());
+    registry.back()->threadId = static_cast<std::uint32_t>(registry.size());
+
+    return *registry.back();
+}
+
+ThreadBuffer &CurrentThreadBuffer()
+{
+    thread_local ThreadBuffer &buffer = RegisterThread();
+    return buffer;
+}
+
+} // namespace
+
+std::uint64_t App::Trace::Now()
+{
+    auto const elapsed = std::chrono::steady_clock::now() - processStart;
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+void App::Trace::Record(char const *name, std::uint64_t begin, std::uint64_t end)
+{
+    ThreadBuffer &buffer = CurrentThreadBuffer();
+
+    std::size_t const n = buffer.count.load(std::memory_order_relaxed);
+    if (n == threadBufferCapacity)
+    {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.events[n] = ZoneEvent{name, begin, end}; // NOLINT
+    buffer.count.store(n + 1, std::memory_order_release);
+}
+
+bool App::Trace::WriteChromeTrace(char const *path)
+{
+    std::ofstream out(path);
+    if (!out.is_open())
+    {
+        std::cerr << "Could not write trace to " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> const lock{registryMutex};
+
+    // Timestamps ("ts") and durations ("dur") are in microseconds
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (auto const &buffer : registry)
+    {
+        std::size_t const n = buffer->count.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            ZoneEvent const &event = buffer->events[i]; // NOLINT
+            out << (first ? "" : ",\n") << R"({"name":")" << event.name
+                << R"(","ph":"X","pid":1,"tid":)" << buffer->threadId
+                << ",\"ts\":" << static_cast<double>(event.begin) / 1e3
+                << ",\"dur\":" << static_cast<double>(event.end - event.begin) / 1e3 << "}";
+            first = false;
+        }
+
+        std::size_t const dropped = buffer->dropped.load(std::memory_order_relaxed);
+        if (dropped != 0)
+        {
+            std::cerr << "Trace: thread " << buffer->threadId << " dropped " << dropped
+                      << " zones (buffer full)\n";
+        }
+    }
+    out << "\n]}\n";
+
+    std::cout << "Trace written to " << path << '\n';
+    return true;
+}
@@ -2,10 +2,169 @@
 /* Following tutorials from Mike Shah */
 /* g++ main.cpp helper.cpp -o prog -lSDL2 -ldl */
 
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+
 #include "App/App.h"
+#include "App/MeshCache.h"
+#include "App/ProgramCache.h"
+#include "App/ProgramPermutations.h"
+#include "App/ShaderSource.h"
+
+namespace {
+
+void PrintUsage(char const *program)
+{
+    std::cerr << "Usage: " << program
+              << " [--headless] [--on-demand] [--vsync MODE] [--fps N] [--animate] [--frames N]"
+                 " [--capture FILE]\n"
+                 "       [--program-cache DIR] [--no-program-cache] [--hot-reload]\n"
+                 "       [--shader-dir DIR] [--features LIST] [--permutations FILE]\n"
+                 "       [--permutation-budget N] [--separable] [--mesh FILE]\n"
+              << "  --headless      render into an offscreen framebuffer (no window, no vsync)\n"
+              << "  --on-demand     only render when something changed (idle otherwise)\n"
+              << "  --vsync MODE    off, on (default) or adaptive\n"
+              << "  --fps N         limit the frame rate to N frames per second\n"
+              << "  --animate       animate the scene\n"
+              << "  --frames N      quit after rendering N frames\n"
+              << "  --capture FILE  record the OpenGL calls of the session (see tools/Replay)\n"
+              << "  --program-cache DIR  store linked program binaries in DIR (default: "
+              << App::ProgramCache::directory << ")\n"
+              << "  --no-program-cache   always compile the shaders from source\n"
+              << "  --hot-reload         apply edits of the shaders while running (reads them\n"
+              << "                       from ./shaders unless --shader-dir is given)\n"
+              << "  --shader-dir DIR     read the shaders from DIR instead of the embedded copies\n"
+              << "  --features LIST      shader features, e.g. vertex_color,instancing,fog\n"
+              << "                       (default: vertex_color; none for none)\n"
+              << "  --permutations FILE  build the shader permutations listed in FILE at startup\n"
+              << "                       and save the ones used to it at exit\n"
+              << "  --permutation-budget N  keep at most N shader permutations in memory\n"
+              << "  --separable          build one program per shader stage and combine them in\n"
+              << "                       program pipelines\n"
+              << "  --mesh FILE          render the mesh in FILE (.obj or .glb)\n"
+              << "  --vertex-format FORMAT  vertex format of the mesh: float, half or snorm16\n"
+              << "                       (default)\n"
+              << "  --stream MODE        upload the vertices every frame: unsynchronized (fenced\n"
+              << "                       ring) or orphaning\n"
+              << "  --no-mesh-cache      always parse the mesh file (do not bake it into "
+              << App::MeshCache::directory << ")\n";
+}
 
-int main()
+/// Parse the command line options into the corresponding App settings.
+/// Exits the program on unknown options.
+///
+/// @return void
+void ParseCommandLine(int argc, char *argv[]) // NOLINT
 {
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view const arg = argv[i]; // NOLINT
+
+        if (arg == "--headless")
+        {
+            App::headless = true;
+        }
+        else if (arg == "--on-demand")
+        {
+            App::loopMode = App::LoopMode::OnDemand;
+        }
+        else if (arg == "--vsync" && i + 1 < argc)
+        {
+            std::string_view const mode = argv[++i]; // NOLINT
+            App::swapInterval = mode == "off"        ? App::SwapInterval::Off
+                                : mode == "adaptive" ? App::SwapInterval::Adaptive
+                                                     : App::SwapInterval::On;
+        }
+        else if (arg == "--fps" && i + 1 < argc)
+        {
+            App::targetFrameRate = std::strtod(argv[++i], nullptr); // NOLINT
+        }
+        else if (arg == "--animate")
+        {
+            App::animate = true;
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+        {
+            App::frameLimit = std::strtoul(argv[++i], nullptr, 10); // NOLINT
+        }
+        else if (arg == "--capture" && i + 1 < argc)
+        {
+            App::glCapturePath = argv[++i]; // NOLINT
+        }
+        else if (arg == "--program-cache" && i + 1 < argc)
+        {
+            App::ProgramCache::directory = argv[++i]; // NOLINT
+        }
+        else if (arg == "--no-program-cache")
+        {
+            App::ProgramCache::enabled = false;
+        }
+        else if (arg == "--hot-reload")
+        {
+            App::hotReload = true;
+        }
+        else if (arg == "--shader-dir" && i + 1 < argc)
+        {
+            App::ShaderSource::directory = argv[++i]; // NOLINT
+        }
+        else if (arg == "--features" && i + 1 < argc)
+        {
+            if (!App::ProgramPermutations::ParseFeatures(argv[++i], App::shaderFeatures)) // NOLINT
+            {
+                exit(1); // NOLINT
+            }
+        }
+        else if (arg == "--permutations" && i + 1 < argc)
+        {
+            App::permutationListPath = argv[++i]; // NOLINT
+        }
+        else if (arg == "--separable")
+        {
+            App::ProgramPermutations::separable = true;
+        }
+        else if (arg == "--mesh" && i + 1 < argc)
+        {
+            App::meshPath = argv[++i]; // NOLINT
+        }
+        else if (arg == "--vertex-format" && i + 1 < argc)
+        {
+            if (!App::Mesh::ParseVertexFormat(argv[++i], App::meshVertexFormat)) // NOLINT
+            {
+                exit(1); // NOLINT
+            }
+        }
+        else if (arg == "--stream" && i + 1 < argc)
+        {
+            if (!App::StreamBuffer::ParseMode(argv[++i], App::streamMode)) // NOLINT
+            {
+                exit(1); // NOLINT
+            }
+            App::streamVertices = true;
+        }
+        else if (arg == "--no-mesh-cache")
+        {
+            App::MeshCache::enabled = false;
+        }
+        else if (arg == "--permutation-budget" && i + 1 < argc)
+        {
+            App::ProgramPermutations::budget = std::strtoul(argv[++i], nullptr, 10); // NOLINT
+        }
+        else
+        {
+            PrintUsage(argv[0]); // NOLINT
+            exit(1);             // NOLINT
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // 0. Select the mode of operation (e.g. headless)
+    ParseCommandLine(argc, argv);
+
     // 1. Setup windowing system and graphics program
     App::Initialize();
 
@@ -0,0 +1,679 @@
+/* OpenGL capture replayer */
+/* Replays a command stream captured with `prog --capture FILE` as fast as possible, without any of */
+/* the application's input handling or logic, and reports the frame times. */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SDL2/SDL.h"
+#include "glad/glad.h"
+
+#include "App/FrameStats.h"
+#include "App/GLCapture.h"
+
+namespace {
+
+using App::GLCapture::Op;
+
+/// A decoded command: opcode and where its payload lives in the capture
+struct Command
+{
+    Op op;
+    unsigned char const *payload;
+    std::uint32_t size;
+};
+
+/// Reads the arguments of a command payload in order. A read past the end of the payload (a
+/// corrupt capture) reads nothing and sets `overrun`.
+struct Reader
+{
+    unsigned char const *p;
+    unsigned char const *end;
+    bool overrun = false;
+
+    /// Whether `count` elements of `size` bytes are left to read (sets `overrun` otherwise)
+    bool Fits(std::uint64_t count, std::size_t size)
+    {
+        if (count > static_cast<std::size_t>(end - p) / size)
+        {
+            overrun = true;
+        }
+        return !overrun;
+    }
+
+    /// The next value, 0 after an overrun
+    template <typename T>
+    T Get()
+    {
+        T value{};
+        if (Fits(1, sizeof(T)))
+        {
+            std::memcpy(&value, p, sizeof(T));
+            p += sizeof(T); // NOLINT
+        }
+        return value;
+    }
+
+    /// The next `size` bytes, nullptr after an overrun
+    unsigned char const *Skip(std::uint64_t size)
+    {
+        if (!Fits(size, 1))
+        {
+            return nullptr;
+        }
+        unsigned char const *data = p;
+        p += size; // NOLINT
+        return data;
+    }
+};
+
+/// Captured object name -> object name in the replay context
+struct NameMap
+{
+    std::vector<GLuint> names;
+
+    GLuint operator[](GLuint captured) const
+    {
+        return captured < names.size() ? names[captured] : 0;
+    }
+
+    void Set(GLuint captured, GLuint live)
+    {
+        if (captured >= names.size())
+        {
+            names.resize(captured + 1, 0);
+        }
+        names[captured] = live;
+    }
+};
+
+struct Context
+{
+    NameMap vertexArrays;
+    NameMap buffers;
+    NameMap shaders;
+    NameMap programs;
+    NameMap programPipelines;
+    NameMap framebuffers;
+    NameMap renderbuffers;
+};
+
+/// Generate `n` objects with `gen` and map the captured names to them
+template <typename GenFunction>
+void Generate(Reader &in, NameMap &map, GenFunction gen)
+{
+    auto const n = in.Get<GLsizei>();
+    if (n < 0 || !in.Fits(static_cast<std::uint64_t>(n), sizeof(GLuint)))
+    {
+        in.overrun = true;
+        return;
+    }
+    std::vector<GLuint> live(static_cast<std::size_t>(n));
+    gen(n, live.data());
+
+    for (GLuint const name : live)
+    {
+        map.Set(in.Get<GLuint>(), name);
+    }
+}
+
+/// Delete the objects with `del` and forget their mapping
+template <typename DeleteFunction>
+void Delete(Reader &in, NameMap &map, DeleteFunction del)
+{
+    auto const n = in.Get<GLsizei>();
+    if (n < 0 || !in.Fits(static_cast<std::uint64_t>(n), sizeof(GLuint)))
+    {
+        in.overrun = true;
+        return;
+    }
+    std::vector<GLuint> live;
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        GLuint const captured = in.Get<GLuint>();
+        live.push_back(map[captured]);
+        map.Set(captured, 0);
+    }
+    del(n, live.data());
+}
+
+/// Replay a glProgramUniform*fv call of `components` floats per element (copied out of the
+/// payload, which is not aligned)
+template <typename UniformFunction>
+void ReplayUniformVector(Reader &in, Context &ctx, std::size_t components, UniformFunction set)
+{
+    GLuint const program = ctx.programs[in.Get<GLuint>()];
+    auto const location = in.Get<GLint>();
+    auto const count = in.Get<GLsizei>();
+    if (count < 0 || !in.Fits(static_cast<std::uint64_t>(count), components * sizeof(GLfloat)))
+    {
+        in.overrun = true;
+        return;
+    }
+    std::vector<GLfloat> value(static_cast<std::size_t>(count) * components);
+    std::memcpy(value.data(), in.Skip(value.size() * sizeof(GLfloat)),
+                value.size() * sizeof(GLfloat));
+    set(program, location, count, value.data());
+}
+
+/// Replay one command
+///
+/// @return bool whether its payload held all of its arguments
+bool Execute(Command const &command, Context &ctx) // NOLINT
+{
+    Reader in{command.payload, command.payload + command.size};
+
+    switch (command.op)
+    {
+        case Op::Frame:
+        case Op::Count:
+            break;
+
+        case Op::GenVertexArrays:
+            Generate(in, ctx.vertexArrays, glGenVertexArrays);
+            break;
+        case Op::DeleteVertexArrays:
+            Delete(in, ctx.vertexArrays, glDeleteVertexArrays);
+            break;
+        case Op::BindVertexArray:
+            glBindVertexArray(ctx.vertexArrays[in.Get<GLuint>()]);
+            break;
+        case Op::GenBuffers:
+            Generate(in, ctx.buffers, glGenBuffers);
+            break;
+        case Op::DeleteBuffers:
+            Delete(in, ctx.buffers, glDeleteBuffers);
+            break;
+        case Op::BindBuffer:
+        {
+            auto const target = in.Get<GLenum>();
+            glBindBuffer(target, ctx.buffers[in.Get<GLuint>()]);
+            break;
+        }
+        case Op::BufferData:
+        {
+            auto const target = in.Get<GLenum>();
+            auto const size = in.Get<std::uint64_t>();
+            auto const usage = in.Get<GLenum>();
+            bool const hasData = in.Get<std::uint8_t>() != 0;
+            unsigned char const *data = hasData ? in.Skip(size) : nullptr;
+            if (!in.overrun)
+            {
+                glBufferData(target, static_cast<GLsizeiptr>(size), data, usage);
+            }
+            break;
+        }
+        case Op::BufferSubData:
+        {
+            auto const target = in.Get<GLenum>();
+            auto const offset = in.Get<std::uint64_t>();
+            auto const size = in.Get<std::uint64_t>();
+            if (unsigned char const *data = in.Skip(size); data != nullptr)
+            {
+                glBufferSubData(target, static_cast<GLintptr>(offset),
+                                static_cast<GLsizeiptr>(size), data);
+            }
+            break;
+        }
+        case Op::EnableVertexAttribArray:
+            glEnableVertexAttribArray(in.Get<GLuint>());
+            break;
+        case Op::DisableVertexAttribArray:
+            glDisableVertexAttribArray(in.Get<GLuint>());
+            break;
+        case Op::VertexAttribPointer:
+        {
+            auto const index = in.Get<GLuint>();
+            auto const size = in.Get<GLint>();
+            auto const type = in.Get<GLenum>();
+            auto const normalized = in.Get<std::uint8_t>();
+            auto const stride = in.Get<GLsizei>();
+            auto const offset = in.Get<std::uint64_t>();
+            glVertexAttribPointer(index, size, type, normalized, stride,
+                                  reinterpret_cast<void const *>(offset)); // NOLINT
+            break;
+        }
+
+        case Op::CreateShader:
+        {
+            auto const type = in.Get<GLenum>();
+            ctx.shaders.Set(in.Get<GLuint>(), glCreateShader(type));
+            break;
+        }
+        case Op::ShaderSource:
+        {
+            GLuint const shader = ctx.shaders[in.Get<GLuint>()];
+            auto const length = static_cast<GLint>(in.Get<std::uint32_t>());
+            auto const *source = reinterpret_cast<GLchar const *>(in.Skip(length)); // NOLINT
+            if (source != nullptr)
+            {
+                glShaderSource(shader, 1, &source, &length);
+            }
+            break;
+        }
+        case Op::CompileShader:
+            glCompileShader(ctx.shaders[in.Get<GLuint>()]);
+            break;
+        case Op::DeleteShader:
+            glDeleteShader(ctx.shaders[in.Get<GLuint>()]);
+            break;
+        case Op::CreateProgram:
+            ctx.programs.Set(in.Get<GLuint>(), glCreateProgram());
+            break;
+        case Op::AttachShader:
+        {
+            GLuint const program = ctx.programs[in.Get<GLuint>()];
+            glAttachShader(program, ctx.shaders[in.Get<GLuint>()]);
+            break;
+        }
+        case Op::DetachShader:
+        {
+            GLuint const program = ctx.programs[in.Get<GLuint>()];
+            glDetachShader(program, ctx.shaders[in.Get<GLuint>()]);
+            break;
+        }
+        case Op::LinkProgram:
+            glLinkProgram(ctx.programs[in.Get<GLuint>()]);
+            break;
+        case Op::ValidateProgram:
+            glValidateProgram(ctx.programs[in.Get<GLuint>()]);
+            break;
+        case Op::UseProgram:
+            glUseProgram(ctx.programs[in.Get<GLuint>()]);
+            break;
+        case Op::DeleteProgram:
+            glDeleteProgram(ctx.programs[in.Get<GLuint>()]);
+            break;
+
+        case Op::Enable:
+            glEnable(in.Get<GLenum>());
+            break;
+        case Op::Disable:
+            glDisable(in.Get<GLenum>());
+            break;
+        case Op::Viewport:
+        {
+            auto const x = in.Get<GLint>();
+            auto const y = in.Get<GLint>();
+            auto const width = in.Get<GLsizei>();
+            glViewport(x, y, width, in.Get<GLsizei>());
+            break;
+        }
+        case Op::ClearColor:
+        {
+            auto const r = in.Get<GLfloat>();
+            auto const g = in.Get<GLfloat>();
+            auto const b = in.Get<GLfloat>();
+            glClearColor(r, g, b, in.Get<GLfloat>());
+            break;
+        }
+        case Op::Clear:
+            glClear(in.Get<GLbitfield>());
+            break;
+        case Op::DrawArrays:
+        {
+            auto const mode = in.Get<GLenum>();
+            auto const first = in.Get<GLint>();
+            glDrawArrays(mode, first, in.Get<GLsizei>());
+            break;
+        }
+        case Op::DrawElements:
+        {
+            auto const mode = in.Get<GLenum>();
+            auto const count = in.Get<GLsizei>();
+            auto const type = in.Get<GLenum>();
+            auto const offset = in.Get<std::uint64_t>();
+            glDrawElements(mode, count, type, reinterpret_cast<void const *>(offset)); // NOLINT
+            break;
+        }
+        case Op::ProgramUniform1i:
+        {
+            GLuint const program = ctx.programs[in.Get<GLuint>()];
+            auto const location = in.Get<GLint>();
+            glProgramUniform1i(program, location, in.Get<GLint>());
+            break;
+        }
+        case Op::ProgramUniform1f:
+        {
+            GLuint const program = ctx.programs[in.Get<GLuint>()];
+            auto const location = in.Get<GLint>();
+            glProgramUniform1f(program, location, in.Get<GLfloat>());
+            break;
+        }
+        case Op::ProgramUniform2fv:
+            ReplayUniformVector(in, ctx, 2, glProgramUniform2fv);
+            break;
+        case Op::ProgramUniform3fv:
+            ReplayUniformVector(in, ctx, 3, glProgramUniform3fv);
+            break;
+        case Op::ProgramUniform4fv:
+            ReplayUniformVector(in, ctx, 4, glProgramUniform4fv);
+            break;
+        case Op::ProgramUniformMatrix4fv:
+        {
+            GLuint const program = ctx.programs[in.Get<GLuint>()];
+            auto const location = in.Get<GLint>();
+            auto const count = in.Get<GLsizei>();
+            auto const transpose = static_cast<GLboolean>(in.Get<std::uint8_t>());
+            if (count < 0 || !in.Fits(static_cast<std::uint64_t>(count), 16 * sizeof(GLfloat)))
+            {
+                in.overrun = true;
+                break;
+            }
+            std::vector<GLfloat> value(static_cast<std::size_t>(count) * 16);
+            std::memcpy(value.data(), in.Skip(value.size() * sizeof(GLfloat)),
+                        value.size() * sizeof(GLfloat));
+            glProgramUniformMatrix4fv(program, location, count, transpose, value.data());
+            break;
+        }
+
+        case Op::ProgramParameteri:
+        {
+            GLuint const program = ctx.programs[in.Get<GLuint>()];
+            auto const pname = in.Get<GLenum>();
+            glProgramParameteri(program, pname, in.Get<GLint>());
+            break;
+        }
+        case Op::GenProgramPipelines:
+            Generate(in, ctx.programPipelines, glGenProgramPipelines);
+            break;
+        case Op::DeleteProgramPipelines:
+            Delete(in, ctx.programPipelines, glDeleteProgramPipelines);
+            break;
+        case Op::BindProgramPipeline:
+            glBindProgramPipeline(ctx.programPipelines[in.Get<GLuint>()]);
+            break;
+        case Op::UseProgramStages:
+        {
+            GLuint const pipeline = ctx.programPipelines[in.Get<GLuint>()];
+            auto const stages = in.Get<GLbitfield>();
+            glUseProgramStages(pipeline, stages, ctx.programs[in.Get<GLuint>()]);
+            break;
+        }
+
+        case Op::DepthFunc:
+            glDepthFunc(in.Get<GLenum>());
+            break;
+        case Op::DepthMask:
+            glDepthMask(static_cast<GLboolean>(in.Get<std::uint8_t>()));
+            break;
+        case Op::CullFace:
+            glCullFace(in.Get<GLenum>());
+            break;
+        case Op::FrontFace:
+            glFrontFace(in.Get<GLenum>());
+            break;
+        case Op::BlendFunc:
+        {
+            auto const sfactor = in.Get<GLenum>();
+            glBlendFunc(sfactor, in.Get<GLenum>());
+            break;
+        }
+
+        case Op::DrawElementsInstanced:
+        {
+            auto const mode = in.Get<GLenum>();
+            auto const count = in.Get<GLsizei>();
+            auto const type = in.Get<GLenum>();
+            auto const offset = in.Get<std::uint64_t>();
+            glDrawElementsInstanced(mode, count, type,
+                                    reinterpret_cast<void const *>(offset), // NOLINT
+                                    in.Get<GLsizei>());
+            break;
+        }
+
+        case Op::GenFramebuffers:
+            Generate(in, ctx.framebuffers, glGenFramebuffers);
+            break;
+        case Op::DeleteFramebuffers:
+            Delete(in, ctx.framebuffers, glDeleteFramebuffers);
+            break;
+        case Op::BindFramebuffer:
+        {
+            auto const target = in.Get<GLenum>();
+            glBindFramebuffer(target, ctx.framebuffers[in.Get<GLuint>()]);
+            break;
+        }
+        case Op::GenRenderbuffers:
+            Generate(in, ctx.renderbuffers, glGenRenderbuffers);
+            break;
+        case Op::DeleteRenderbuffers:
+            Delete(in, ctx.renderbuffers, glDeleteRenderbuffers);
+            break;
+        case Op::BindRenderbuffer:
+        {
+            auto const target = in.Get<GLenum>();
+            glBindRenderbuffer(target, ctx.renderbuffers[in.Get<GLuint>()]);
+            break;
+        }
+        case Op::RenderbufferStorage:
+        {
+            auto const target = in.Get<GLenum>();
+            auto const format = in.Get<GLenum>();
+            auto const width = in.Get<GLsizei>();
+            glRenderbufferStorage(target, format, width, in.Get<GLsizei>());
+            break;
+        }
+        case Op::FramebufferRenderbuffer:
+        {
+            auto const target = in.Get<GLenum>();
+            auto const attachment = in.Get<GLenum>();
+            auto const renderbufferTarget = in.Get<GLenum>();
+            glFramebufferRenderbuffer(target, attachment, renderbufferTarget,
+                                      ctx.renderbuffers[in.Get<GLuint>()]);
+            break;
+        }
+    }
+
+    return !in.overrun;
+}
+
+/// Split the capture into commands
+///
+/// @return bool whether the capture is well formed
+bool Decode(std::vector<unsigned char> const &capture, std::vector<Command> &commands)
+{
+    std::size_t offset = sizeof(App::GLCapture::CaptureHeader);
+
+    while (offset + App::GLCapture::commandHeaderSize <= capture.size())
+    {
+        Reader in{&capture[offset], capture.data() + capture.size()};
+        auto const op = in.Get<std::uint16_t>();
+        auto const size = in.Get<std::uint32_t>();
+        offset += App::GLCapture::commandHeaderSize;
+
+        if (op >= static_cast<std::uint16_t>(Op::Count) || offset + size > capture.size())
+        {
+            std::cerr << "Corrupt or unsupported command " << op << " at offset " << offset
+                      << std::endl;
+            return false;
+        }
+
+        commands.push_back(Command{static_cast<Op>(op), &capture[offset], size});
+        offset += size;
+    }
+
+    if (offset != capture.size())
+    {
+        std::cerr << "Truncated capture: " << capture.size() - offset
+                  << " bytes left after the last command" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void CreateContext(int width, int height, bool window)
+{
+    if (!window && SDL_getenv("SDL_VIDEODRIVER") == nullptr)
+    {
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0)
+    {
+        std::cerr << "SDL2 could not initialize video subsystem: " << SDL_GetError() << std::endl;
+        exit(1); // NOLINT
+    }
+
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+
+    SDL_Window *sdlWindow = SDL_CreateWindow(
+        "Replay", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width, height, // NOLINT
+        SDL_WINDOW_OPENGL | (window ? SDL_WINDOW_SHOWN : SDL_WINDOW_HIDDEN));
+    if (sdlWindow == nullptr || SDL_GL_CreateContext(sdlWindow) == nullptr)
+    {
+        std::cerr << "Could not create an OpenGL context: " << SDL_GetError() << std::endl;
+        exit(2); // NOLINT
+    }
+
+    if (gladLoadGLLoader(static_cast<GLADloadproc>(SDL_GL_GetProcAddress)) == 0)
+    {
+        std::cerr << "Could not initialize Glad." << std::endl;
+        exit(3); // NOLINT
+    }
+
+    SDL_GL_SetSwapInterval(0);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    char const *path = nullptr;
+    unsigned long loops = 1;
+    bool window = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view const arg = argv[i]; // NOLINT
+        if (arg == "--loops" && i + 1 < argc)
+        {
+            loops = std::strtoul(argv[++i], nullptr, 10); // NOLINT
+        }
+        else if (arg == "--window")
+        {
+            window = true;
+        }
+        else if (path == nullptr && arg[0] != '-')
+        {
+            path = argv[i]; // NOLINT
+        }
+        else
+        {
+            path = nullptr;
+            break;
+        }
+    }
+
+    if (path == nullptr)
+    {
+        std::cerr << "Usage: " << argv[0] << " CAPTURE [--loops N] [--window]\n" // NOLINT
+                  << "  --loops N  replay the captured frames N times (default 1)\n"
+                  << "  --window   replay into a visible window instead of offscreen\n";
+        return 1;
+    }
+
+    // The whole capture is loaded up front so that replaying does no I/O
+    std::ifstream file(path, std::ios::binary);
+    std::vector<unsigned char> const capture{std::istreambuf_iterator<char>(file),
+                                             std::istreambuf_iterator<char>()};
+
+    App::GLCapture::CaptureHeader header{};
+    if (capture.size() < sizeof(header))
+    {
+        std::cerr << "Could not read capture " << path << std::endl;
+        return 1;
+    }
+    std::memcpy(&header, capture.data(), sizeof(header));
+    if (header.magic != App::GLCapture::magic || header.version != App::GLCapture::version)
+    {
+        std::cerr << path << " is not a capture of version " << App::GLCapture::version
+                  << std::endl;
+        return 1;
+    }
+
+    std::vector<Command> commands;
+    if (!Decode(capture, commands))
+    {
+        return 1;
+    }
+
+    CreateContext(header.width, header.height, window);
+    Context ctx;
+
+    auto const replay = [&](std::size_t i) {
+        if (!Execute(commands[i], ctx))
+        {
+            std::cerr << "Corrupt command " << static_cast<unsigned>(commands[i].op) << " (#" << i
+                      << "): its payload is shorter than its arguments" << std::endl;
+            SDL_Quit();
+            exit(4); // NOLINT
+        }
+    };
+
+    // Everything before the first frame is setup, replayed once
+    std::size_t firstFrame = 0;
+    while (firstFrame < commands.size() && commands[firstFrame].op != Op::Frame)
+    {
+        replay(firstFrame++);
+    }
+    glFinish();
+
+    using Clock = std::chrono::steady_clock;
+    App::FrameStats::RollingWindow frameTimes;
+    unsigned long frames = 0;
+    auto const start = Clock::now();
+    auto frameStart = start;
+
+    for (unsigned long loop = 0; loop < loops; ++loop)
+    {
+        for (std::size_t i = firstFrame; i < commands.size(); ++i)
+        {
+            if (commands[i].op != Op::Frame)
+            {
+                replay(i);
+                continue;
+            }
+
+            // End of the previous frame
+            if (i != firstFrame || loop != 0)
+            {
+                if (window)
+                {
+                    SDL_GL_SwapWindow(SDL_GL_GetCurrentWindow());
+                }
+                else
+                {
+                    glFlush();
+                }
+                auto const now = Clock::now();
+                frameTimes.Record(static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now - frameStart).count()));
+                frameStart = now;
+                ++frames;
+            }
+        }
+    }
+    glFinish();
+
+    double const seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << "Replayed " << commands.size() << " commands, " << frames << " frames in "
+              << seconds << " s (" << (seconds > 0.0 ? static_cast<double>(frames) / seconds : 0.0)
+              << " frames/s) on " << glGetString(GL_RENDERER) << '\n';
+    App::FrameStats::DumpRow(std::cout, "Frame", frameTimes.Summarize());
+
+    SDL_Quit();
+    return 0;
+}
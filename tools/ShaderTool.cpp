@@ -0,0 +1,273 @@
+/* Offline shader validation and minification */
+/* Preprocesses every permutation of the shaders the way the application does, minifies it, and */
+/* compiles and links it with the driver, so that shader errors show up at build time. The build */
+/* embeds the minified sources it writes into the application. */
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "SDL2/SDL.h"
+#include "glad/glad.h"
+
+#include "App/ProgramPermutations.h"
+#include "App/Shader.h"
+#include "App/ShaderMinifier.h"
+#include "App/ShaderSource.h"
+
+namespace {
+
+using App::ProgramPermutations::Key;
+
+/// A program to check: one permutation, or one stage of a permutation built as a separable program
+struct Job
+{
+    std::string name;            // e.g. "VERTEX_COLOR+FOG", "separable.INSTANCING"
+    App::Shader::Sources source; // Unused stage left empty
+    App::Shader::Sources minified;
+    App::Shader::Sources files; // Name of each minified stage (see ShaderSource::PrebuiltName)
+    App::Shader::PendingProgram pending;
+};
+
+struct Options
+{
+    std::filesystem::path output; // Where to write the minified sources (nowhere if empty)
+    bool validate = true;
+};
+
+void PrintUsage(char const *program)
+{
+    std::cerr << "Usage: " << program << " [--shader-dir DIR] [--out DIR] [--no-validate]\n"
+              << "  --shader-dir DIR  read the shaders from DIR instead of the embedded copies\n"
+              << "  --out DIR         write the minified source of every permutation to DIR, as\n"
+              << "                    embedded by the build\n"
+              << "  --no-validate     only minify (no OpenGL context needed)\n";
+}
+
+Options ParseCommandLine(int argc, char *argv[]) // NOLINT
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view const arg = argv[i]; // NOLINT
+        if (arg == "--shader-dir" && i + 1 < argc)
+        {
+            App::ShaderSource::directory = argv[++i]; // NOLINT
+        }
+        else if (arg == "--out" && i + 1 < argc)
+        {
+            options.output = argv[++i]; // NOLINT
+        }
+        else if (arg == "--no-validate")
+        {
+            options.validate = false;
+        }
+        else
+        {
+            PrintUsage(argv[0]); // NOLINT
+            exit(1);             // NOLINT
+        }
+    }
+
+    return options;
+}
+
+void CreateContext()
+{
+    if (SDL_getenv("SDL_VIDEODRIVER") == nullptr)
+    {
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0)
+    {
+        std::cerr << "SDL2 could not initialize video subsystem: " << SDL_GetError() << std::endl;
+        exit(1); // NOLINT
+    }
+
+    // The same context as the application's
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+
+    SDL_Window *window = SDL_CreateWindow("ShaderTool", SDL_WINDOWPOS_UNDEFINED,
+                                          SDL_WINDOWPOS_UNDEFINED, 1, 1,
+                                          SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    if (window == nullptr || SDL_GL_CreateContext(window) == nullptr)
+    {
+        std::cerr << "Could not create an OpenGL context: " << SDL_GetError() << std::endl;
+        exit(2); // NOLINT
+    }
+
+    if (gladLoadGLLoader(static_cast<GLADloadproc>(SDL_GL_GetProcAddress)) == 0)
+    {
+        std::cerr << "Could not initialize Glad." << std::endl;
+        exit(3); // NOLINT
+    }
+
+    App::Shader::Initialize();
+}
+
+/// Every permutation, then every stage variant of the separable programs
+std::vector<Job> CollectJobs()
+{
+    std::vector<Job> jobs;
+    Key const permutationCount = 1U << App::ProgramPermutations::FeatureCount;
+
+    for (Key key = 0; key < permutationCount; ++key)
+    {
+        std::string name = App::ProgramPermutations::ToString(key);
+        std::replace(name.begin(), name.end(), ',', '+');
+        std::vector<std::string> const defines = App::ProgramPermutations::Defines(key);
+        jobs.push_back({name,
+                        App::ProgramPermutations::LoadSources(key),
+                        {},
+                        {App::ShaderSource::PrebuiltName("vert.glsl", defines),
+                         App::ShaderSource::PrebuiltName("frag.glsl", defines)},
+                        {}});
+    }
+
+    for (Key key = 0; key < permutationCount; ++key)
+    {
+        std::string name = App::ProgramPermutations::ToString(key);
+        std::replace(name.begin(), name.end(), ',', '+');
+        if ((key & ~App::ProgramPermutations::vertexFeatures) == 0)
+        {
+            std::string source = App::ProgramPermutations::LoadStageSource(GL_VERTEX_SHADER, key);
+            std::string file = App::ShaderSource::PrebuiltName(
+                "vert.glsl", App::ProgramPermutations::StageDefines(GL_VERTEX_SHADER, key));
+            jobs.push_back(
+                {"separable." + name, {std::move(source), {}}, {}, {std::move(file), {}}, {}});
+        }
+        if ((key & ~App::ProgramPermutations::fragmentFeatures) == 0)
+        {
+            std::string source = App::ProgramPermutations::LoadStageSource(GL_FRAGMENT_SHADER, key);
+            std::string file = App::ShaderSource::PrebuiltName(
+                "frag.glsl", App::ProgramPermutations::StageDefines(GL_FRAGMENT_SHADER, key));
+            jobs.push_back(
+                {"separable." + name, {{}, std::move(source)}, {}, {{}, std::move(file)}, {}});
+        }
+    }
+
+    return jobs;
+}
+
+/// Submit a program built from these sources (a separable stage program if one is empty)
+App::Shader::PendingProgram Submit(App::Shader::Sources const &sources)
+{
+    if (sources.fragment.empty())
+    {
+        return App::Shader::SubmitStage(GL_VERTEX_SHADER, sources.vertex);
+    }
+    if (sources.vertex.empty())
+    {
+        return App::Shader::SubmitStage(GL_FRAGMENT_SHADER, sources.fragment);
+    }
+    return App::Shader::Submit(sources.vertex, sources.fragment);
+}
+
+void WriteFile(std::filesystem::path const &path, std::string const &contents)
+{
+    std::ofstream file(path, std::ios::binary);
+    file << contents;
+    if (!file)
+    {
+        std::cerr << "Could not write " << path << std::endl;
+        exit(4); // NOLINT
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options const options = ParseCommandLine(argc, argv);
+
+    // Preprocess the sources exactly as the application does (the tool only embeds the shader files
+    // themselves, not the prebuilt permutations), and keep the full ones to compare
+    std::vector<Job> jobs = CollectJobs();
+
+    std::size_t sourceBytes = 0;
+    std::size_t minifiedBytes = 0;
+    for (Job &job : jobs)
+    {
+        if (job.source.vertex.empty() && job.source.fragment.empty())
+        {
+            std::cerr << job.name << ": could not load the shaders" << std::endl;
+            return 1;
+        }
+        for (auto member : {&App::Shader::Sources::vertex, &App::Shader::Sources::fragment})
+        {
+            if (!(job.source.*member).empty())
+            {
+                job.minified.*member = App::ShaderMinifier::Minify(job.source.*member);
+                sourceBytes += (job.source.*member).size();
+                minifiedBytes += (job.minified.*member).size();
+            }
+        }
+    }
+
+    if (!options.output.empty())
+    {
+        std::filesystem::create_directories(options.output);
+        for (Job const &job : jobs)
+        {
+            if (!job.minified.vertex.empty())
+            {
+                WriteFile(options.output / job.files.vertex, job.minified.vertex);
+            }
+            if (!job.minified.fragment.empty())
+            {
+                WriteFile(options.output / job.files.fragment, job.minified.fragment);
+            }
+        }
+    }
+
+    std::cout << jobs.size() << " programs, " << sourceBytes << " bytes of source minified to "
+              << minifiedBytes << " bytes" << std::endl;
+
+    if (!options.validate)
+    {
+        return 0;
+    }
+
+    // Submit everything first so that the driver can compile in parallel, then check
+    CreateContext();
+    for (Job &job : jobs)
+    {
+        job.pending = Submit(job.minified);
+    }
+
+    unsigned long failures = 0;
+    for (Job &job : jobs)
+    {
+        GLuint const program = App::Shader::Finish(job.pending);
+        if (program != 0)
+        {
+            glDeleteProgram(program);
+            continue;
+        }
+
+        ++failures;
+        std::cerr << job.name << ": does not compile" << std::endl;
+
+        // Tell a minifier bug from a shader bug
+        App::Shader::PendingProgram original = Submit(job.source);
+        if (GLuint const check = App::Shader::Finish(original); check != 0)
+        {
+            std::cerr << job.name << ": the unminified source compiles (minifier bug)" << std::endl;
+            glDeleteProgram(check);
+        }
+    }
+
+    std::cout << jobs.size() - failures << "/" << jobs.size() << " programs valid" << std::endl;
+    SDL_Quit();
+    return failures == 0 ? 0 : 1;
+}